@@ -0,0 +1,15 @@
+#per-tick cost of enemy targeting, entity grid collisions and bullet collisions with 100, 1000 and 4000 enemies
+#run from the repository root: sh bench/entities.sh [ticks]
+
+TICKS=${1:-300}
+
+for ENEMIES in 100 1000 4000; do
+
+	g++ lib/engine/*.cpp lib/glad/gl.c main.cpp -O2 -DENGINE_HEADLESS -DBENCH_ENEMIES=$ENEMIES -I ./include/ -ldl -lm -lpthread -o main-bench || exit 1
+
+	echo "--- $ENEMIES enemies ---"
+	./main-bench -t $TICKS -q -p bench-entities.json | grep -E "^(entityPhysics|entityParticleCollisions|bulletCollisions|update) |^avg|^p99"
+
+done
+
+rm -f bench-entities.json
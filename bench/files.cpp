@@ -0,0 +1,172 @@
+//compares the old fgetc and fputc file functions with fread, mmap and the buffered writer on a multi megabyte mesh file
+//build and run from the repository root with bench/files.sh
+
+#include "engine/files.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+const char *MESH_PATH = "bench-files.mesh";
+
+int NUMBER_OF_TRIANGLES = 200000;
+int NUMBER_OF_ITERATIONS = 10;
+
+double getTimeMilliseconds(){
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+
+}
+
+//the file functions as they were before
+char *getFileData_byteByByte_mustFree(const char *path, long int *fileSizeOut){
+
+	FILE *fileHandle = fopen(path, "r");
+
+	fseek(fileHandle, 0L, SEEK_END);
+	long int fileSize = ftell(fileHandle);
+	fseek(fileHandle, 0L, 0);
+
+	char *data = (char *)malloc(sizeof(char) * fileSize + 1);
+	memset(data, 0, sizeof(char) * fileSize + 1);
+
+	for(int i = 0; i < fileSize; i++){
+		data[i] = fgetc(fileHandle);
+	}
+
+	fclose(fileHandle);
+
+	*fileSizeOut = fileSize;
+
+	return data;
+
+}
+
+void writeDataToFile_byteByByte(const char *path, const char *data_p, long int fileSize){
+
+	FILE *fileHandle = fopen(path, "w");
+
+	for(int i = 0; i < fileSize; i++){
+		fputc(data_p[i], fileHandle);
+	}
+
+	fclose(fileHandle);
+
+}
+
+//reads every byte so that mapped pages are actually faulted in
+unsigned int getChecksum(const char *data, long int size){
+
+	unsigned int checksum = 0;
+
+	for(long int i = 0; i < size; i++){
+		checksum = checksum * 31 + (unsigned char)data[i];
+	}
+
+	return checksum;
+
+}
+
+int main(){
+
+	//positions, texture coordinates and normals like the mesh files loaded by Model_initFromFile_mesh
+	long int meshSize = NUMBER_OF_TRIANGLES * 3 * 8 * sizeof(float);
+	float *mesh = (float *)malloc(meshSize);
+
+	srand(1);
+
+	for(int i = 0; i < NUMBER_OF_TRIANGLES * 3 * 8; i++){
+		mesh[i] = (float)rand() / (float)RAND_MAX;
+	}
+
+	unsigned int meshChecksum = getChecksum((const char *)mesh, meshSize);
+
+	printf("mesh file: %.1f MB\n", meshSize / 1000000.0);
+
+	double startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		writeDataToFile_byteByByte(MESH_PATH, (const char *)mesh, meshSize);
+	}
+
+	printf("write fputc:      %8.3f ms\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		writeDataToFile(MESH_PATH, (const char *)mesh, meshSize);
+	}
+
+	printf("write FileWriter: %8.3f ms (including fsync)\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	//every read below also checksums the data, this is what that costs on its own
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		meshChecksum = getChecksum((const char *)mesh, meshSize);
+	}
+
+	printf("checksum only:    %8.3f ms\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	bool correct = true;
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+
+		long int fileSize;
+		char *data = getFileData_byteByByte_mustFree(MESH_PATH, &fileSize);
+
+		correct = correct && getChecksum(data, fileSize) == meshChecksum;
+
+		free(data);
+
+	}
+
+	printf("read fgetc:       %8.3f ms\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+
+		long int fileSize;
+		char *data = getFileData_mustFree(MESH_PATH, &fileSize);
+
+		correct = correct && getChecksum(data, fileSize) == meshChecksum;
+
+		free(data);
+
+	}
+
+	printf("read fread:       %8.3f ms\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+
+		FileView fileView;
+		FileView_init(&fileView, MESH_PATH);
+
+		correct = correct && fileView.mapped && getChecksum(fileView.data, fileView.size) == meshChecksum;
+
+		FileView_release(&fileView);
+
+	}
+
+	printf("read FileView:    %8.3f ms\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS);
+
+	if(!correct){
+		printf("DATA MISMATCH\n");
+	}
+
+	remove(MESH_PATH);
+
+	free(mesh);
+
+	return 0;
+
+}
@@ -0,0 +1,6 @@
+#byte by byte file reading and writing versus the bulk and mapped file functions, on a generated mesh file
+#run from the repository root: sh bench/files.sh
+
+g++ bench/files.cpp lib/engine/files.cpp lib/engine/strings.cpp -O2 -I ./include/ -lm -o bench-files || exit 1
+
+./bench-files
@@ -0,0 +1,94 @@
+//compares the scalar and SIMD particle integration kernels on the same data
+//build and run from the repository root with bench/integration.sh
+
+#include "engine/particles.h"
+#include "engine/geometry.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+int NUMBER_OF_PARTICLES = 1000000;
+int NUMBER_OF_ITERATIONS = 200;
+
+double getTimeMilliseconds(){
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+
+}
+
+void initBenchParticles(Particles *particles_p){
+
+	Particles_init(particles_p);
+
+	srand(1);
+
+	for(int i = 0; i < NUMBER_OF_PARTICLES; i++){
+		Particles_add(particles_p, i, getVec2f(rand() % 1920, rand() % 1080));
+	}
+
+}
+
+double runKernel(Particles *particles_p, ParticleForces forces, bool simd){
+
+	double startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		if(simd){
+			Particles_integrate_simd(particles_p, forces, 0, particles_p->length);
+		}else{
+			Particles_integrate_scalar(particles_p, forces, 0, particles_p->length);
+		}
+	}
+
+	return (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS;
+
+}
+
+int main(){
+
+	ParticleForces forces;
+	forces.gravity = 0.1;
+	forces.resistance = 0.97;
+	forces.bending = true;
+	forces.bendingPos = getVec2f(960.0, 540.0);
+	forces.bendingForce = 0.01;
+
+	Particles scalarParticles;
+	Particles simdParticles;
+
+	initBenchParticles(&scalarParticles);
+	initBenchParticles(&simdParticles);
+
+	double scalarTime = runKernel(&scalarParticles, forces, false);
+	double simdTime = runKernel(&simdParticles, forces, true);
+
+	bool resultsMatch = true;
+	for(int c = 0; c < 2; c++){
+		if(memcmp(scalarParticles.velocity[c].data(), simdParticles.velocity[c].data(), sizeof(float) * NUMBER_OF_PARTICLES) != 0
+		|| memcmp(scalarParticles.lastPos[c].data(), simdParticles.lastPos[c].data(), sizeof(float) * NUMBER_OF_PARTICLES) != 0){
+			resultsMatch = false;
+		}
+	}
+
+#if defined(__AVX__)
+	const char *simdName = "AVX";
+#elif defined(__SSE2__)
+	const char *simdName = "SSE2";
+#else
+	const char *simdName = "none";
+#endif
+
+	printf("particles: %i\n", NUMBER_OF_PARTICLES);
+	printf("scalar: %f ms\n", scalarTime);
+	printf("simd (%s): %f ms\n", simdName, simdTime);
+	printf("speedup: %f\n", scalarTime / simdTime);
+	printf("results match: %s\n", resultsMatch ? "yes" : "no");
+
+	return resultsMatch ? 0 : 1;
+
+}
@@ -0,0 +1,11 @@
+#scalar versus SIMD particle integration, once with the default SSE2 target and once with AVX2
+#run from the repository root: sh bench/integration.sh
+
+for FLAGS in "" "-mavx2"; do
+
+	g++ bench/integration.cpp lib/engine/particles.cpp lib/engine/jobs.cpp lib/engine/profiler.cpp lib/engine/time.cpp lib/engine/geometry.cpp -O2 $FLAGS -I ./include/ -lm -lpthread -o bench-integration || exit 1
+
+	echo "--- g++ -O2 $FLAGS ---"
+	./bench-integration
+
+done
@@ -0,0 +1,172 @@
+//measures how far frame intervals are from 1/60 s with the old and new way of waiting for the next frame
+//each frame works on the CPU for a while and then blocks for a while, like when waiting for the driver in glXSwapBuffers
+//build and run from the repository root with bench/pacing.sh
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "math.h"
+#include "time.h"
+#include "unistd.h"
+#include "poll.h"
+#include <vector>
+#include <algorithm>
+
+int NUMBER_OF_FRAMES = 300;
+long long FRAME_TIME = 1000000000LL / 60;
+long long WORK_TIME = 3000000;
+long long BLOCKED_TIME = 4000000;
+
+//same as FRAME_PACER_SPIN_TIME in engine.cpp
+#define FRAME_PACER_SPIN_TIME 500000
+
+long long getTimeNanoseconds(){
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (long long)time.tv_sec * 1000000000LL + time.tv_nsec;
+
+}
+
+void simulateFrame(){
+
+	long long startTime = getTimeNanoseconds();
+
+	while(getTimeNanoseconds() - startTime < WORK_TIME){
+	}
+
+	usleep(BLOCKED_TIME / 1000);
+
+}
+
+//the loop as it was before
+void waitForNextFrame_clock(size_t startTicks){
+
+	size_t frameTime = 1000000 / 60;
+
+	size_t deltaTime = (clock() - startTicks) / (CLOCKS_PER_SEC / 1000000);
+
+	int lag = frameTime - deltaTime;
+
+	if(lag < 0){
+		lag = 0;
+	}
+
+	usleep(lag);
+
+}
+
+long long nextFrameTime = 0;
+
+//the same as waitForNextFrame in engine.cpp, with a pipe that never gets data instead of the X connection
+void waitForNextFrame_monotonic(int fd){
+
+	long long currentTime = getTimeNanoseconds();
+
+	if(nextFrameTime == 0){
+		nextFrameTime = currentTime;
+	}
+
+	nextFrameTime += FRAME_TIME;
+
+	if(nextFrameTime < currentTime){
+		nextFrameTime = currentTime;
+		return;
+	}
+
+	struct pollfd connection;
+	connection.fd = fd;
+	connection.events = POLLIN;
+
+	while(true){
+
+		long long sleepTime = nextFrameTime - FRAME_PACER_SPIN_TIME - getTimeNanoseconds();
+
+		if(sleepTime <= 0){
+			break;
+		}
+
+		struct timespec timeout;
+		timeout.tv_sec = sleepTime / 1000000000LL;
+		timeout.tv_nsec = sleepTime % 1000000000LL;
+
+		ppoll(&connection, 1, &timeout, NULL);
+
+	}
+
+	while(getTimeNanoseconds() < nextFrameTime){
+	}
+
+}
+
+void printJitter(const char *name, std::vector<long long> frameStartTimes){
+
+	std::vector<double> jitters;
+	double intervalSum = 0.0;
+
+	for(int i = 1; i < frameStartTimes.size(); i++){
+
+		long long interval = frameStartTimes[i] - frameStartTimes[i - 1];
+
+		intervalSum += interval;
+		jitters.push_back(fabs((double)(interval - FRAME_TIME)) / 1000.0);
+
+	}
+
+	std::sort(jitters.begin(), jitters.end());
+
+	double jitterSum = 0.0;
+	for(int i = 0; i < jitters.size(); i++){
+		jitterSum += jitters[i];
+	}
+
+	printf("%-10s interval avg %8.3f ms, jitter avg %8.1f us, p99 %8.1f us, max %8.1f us\n",
+		name,
+		intervalSum / jitters.size() / 1000000.0,
+		jitterSum / jitters.size(),
+		jitters[(jitters.size() - 1) * 99 / 100],
+		jitters.back()
+	);
+
+}
+
+int main(){
+
+	printf("target interval %.3f ms, %.1f ms working and %.1f ms blocked per frame\n", FRAME_TIME / 1000000.0, WORK_TIME / 1000000.0, BLOCKED_TIME / 1000000.0);
+
+	std::vector<long long> frameStartTimes;
+
+	for(int i = 0; i < NUMBER_OF_FRAMES; i++){
+
+		size_t startTicks = clock();
+
+		frameStartTimes.push_back(getTimeNanoseconds());
+
+		simulateFrame();
+
+		waitForNextFrame_clock(startTicks);
+
+	}
+
+	printJitter("clock", frameStartTimes);
+
+	int pipeFds[2];
+	pipe(pipeFds);
+
+	frameStartTimes.clear();
+
+	for(int i = 0; i < NUMBER_OF_FRAMES; i++){
+
+		frameStartTimes.push_back(getTimeNanoseconds());
+
+		simulateFrame();
+
+		waitForNextFrame_monotonic(pipeFds[0]);
+
+	}
+
+	printJitter("monotonic", frameStartTimes);
+
+	return 0;
+
+}
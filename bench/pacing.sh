@@ -0,0 +1,6 @@
+#frame pacing with clock and usleep versus the monotonic clock pacer in engine.cpp, on frames that spend time both working and blocked
+#run from the repository root: sh bench/pacing.sh
+
+g++ bench/pacing.cpp -O2 -I ./include/ -lm -o bench-pacing || exit 1
+
+./bench-pacing
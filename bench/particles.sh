@@ -0,0 +1,17 @@
+#per-tick simulation cost with 10k, 100k and 1M particles piled on the ground
+#freeCellSearchProbes is how many cells the free cell searches would have tried one at a time, worked out from the distance to the cell they found rather than measured by running the old search
+#freeCellSearchLineReads is how many occupancy words of up to 64 cells they read instead, freeCellSearchDirectChecks how many single cells the static collisions read before reading any words
+#run from the repository root: sh bench/particles.sh [ticks]
+
+TICKS=${1:-300}
+
+for PARTICLES in 10000 100000 1000000; do
+
+	g++ lib/engine/*.cpp lib/glad/gl.c main.cpp -O2 -DENGINE_HEADLESS -DBENCH_PARTICLES=$PARTICLES -I ./include/ -ldl -lm -lpthread -o main-bench || exit 1
+
+	echo "--- $PARTICLES particles ---"
+	./main-bench -t $TICKS -q -p bench-particles.json | grep -E "^(staticParticleCollisions|movingParticleCollisions|entityParticleCollisions|update|freeCellSearchProbes|freeCellSearchLineReads|freeCellSearchDirectChecks) |^avg|^p99|^max"
+
+done
+
+rm -f bench-particles.json
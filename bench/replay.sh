@@ -0,0 +1,28 @@
+#input log checks: idle ticks have to be kept as a single record, and replaying a log has to end with the same state hash as the recorded run
+#run from the repository root: sh bench/replay.sh [ticks]
+
+TICKS=${1:-200}
+
+g++ lib/engine/*.cpp lib/glad/gl.c main.cpp -O2 -DENGINE_HEADLESS -I ./include/ -ldl -lm -lpthread -o main-bench || exit 1
+
+RECORDED=$(./main-bench -t $TICKS -q -r bench-replay.log)
+REPLAYED=$(./main-bench -q -i bench-replay.log)
+
+echo "$RECORDED" | grep -E "^Recorded|^state hash"
+echo "$REPLAYED" | grep -E "^state hash"
+
+rm -f bench-replay.log
+
+FAILED=0
+
+if ! echo "$RECORDED" | grep -q "in 1 records"; then
+	echo "FAILED: $TICKS idle ticks were not kept as a single record"
+	FAILED=1
+fi
+
+if [ "$(echo "$RECORDED" | grep "^state hash")" != "$(echo "$REPLAYED" | grep "^state hash")" ]; then
+	echo "FAILED: the replay ended with a different state hash"
+	FAILED=1
+fi
+
+exit $FAILED
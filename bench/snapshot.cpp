@@ -0,0 +1,109 @@
+//run length encoding of a 1920x1080 material grid in 64x64 chunks like the one in main.cpp, compared with writing the cells raw
+//build and run from the repository root with bench/snapshot.sh
+
+#include "engine/compression.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#include <vector>
+
+int GRID_WIDTH = 1920;
+int GRID_HEIGHT = 1080;
+int CHUNK_SIZE = 64;
+int NUMBER_OF_ITERATIONS = 100;
+
+double getTimeMilliseconds(){
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+
+}
+
+int main(){
+
+	int chunksWidth = (GRID_WIDTH + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	int chunksHeight = (GRID_HEIGHT + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	int chunkArea = CHUNK_SIZE * CHUNK_SIZE;
+	int numberOfChunks = chunksWidth * chunksHeight;
+
+	//air over rolling ground with some loose rock on top and holes dug into it, every chunk allocated
+	std::vector<unsigned char> chunks(numberOfChunks * chunkArea, 0);
+
+	srand(1);
+
+	for(int x = 0; x < chunksWidth * CHUNK_SIZE; x++){
+
+		int groundHeight = GRID_HEIGHT / 2 + (x * 7 % 200) - 100;
+
+		for(int y = 0; y < chunksHeight * CHUNK_SIZE; y++){
+
+			unsigned char material = 0;
+
+			if(y > groundHeight){
+				material = 2;
+			}
+			if(y > groundHeight - 5
+			&& y <= groundHeight
+			&& rand() % 3 == 0){
+				material = 1;
+			}
+			if(y > groundHeight + 50
+			&& (x / 40 + y / 40) % 7 == 0){
+				material = 0;
+			}
+
+			int chunkIndex = (y / CHUNK_SIZE) * chunksWidth + x / CHUNK_SIZE;
+			chunks[chunkIndex * chunkArea + (y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] = material;
+
+		}
+	}
+
+	std::vector<unsigned char> encoded;
+	std::vector<unsigned char> decoded(chunks.size());
+
+	double startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		encoded.clear();
+		for(int j = 0; j < numberOfChunks; j++){
+			RunLength_encode(&encoded, &chunks[j * chunkArea], chunkArea);
+		}
+	}
+
+	double encodeTime = (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS;
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		int offset = 0;
+		for(int j = 0; j < numberOfChunks; j++){
+			offset += RunLength_decode(&decoded[j * chunkArea], chunkArea, &encoded[offset], encoded.size() - offset);
+		}
+	}
+
+	double decodeTime = (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS;
+
+	startTime = getTimeMilliseconds();
+
+	for(int i = 0; i < NUMBER_OF_ITERATIONS; i++){
+		memcpy(decoded.data(), chunks.data(), chunks.size());
+	}
+
+	double copyTime = (getTimeMilliseconds() - startTime) / NUMBER_OF_ITERATIONS;
+
+	if(memcmp(decoded.data(), chunks.data(), chunks.size()) != 0){
+		printf("decoded grid is not the same as the encoded one\n");
+		return 1;
+	}
+
+	printf("%i chunks of %ix%i\n", numberOfChunks, CHUNK_SIZE, CHUNK_SIZE);
+	printf("raw: %i bytes, copied in %f ms\n", (int)chunks.size(), copyTime);
+	printf("run length: %i bytes (%.1fx smaller), encoded in %f ms, decoded in %f ms\n", (int)encoded.size(), (double)chunks.size() / encoded.size(), encodeTime, decodeTime);
+
+	return 0;
+
+}
@@ -0,0 +1,18 @@
+#snapshot size and speed, for the grid codec on its own and for saving and loading the whole world with 10k, 100k and 1M particles
+#run from the repository root: sh bench/snapshot.sh
+
+g++ bench/snapshot.cpp lib/engine/compression.cpp -O2 -I ./include/ -lm -o bench-snapshot || exit 1
+
+./bench-snapshot
+
+for PARTICLES in 10000 100000 1000000; do
+
+	g++ lib/engine/*.cpp lib/glad/gl.c main.cpp -O2 -DENGINE_HEADLESS -DBENCH_PARTICLES=$PARTICLES -I ./include/ -ldl -lm -lpthread -o main-bench || exit 1
+
+	echo "--- $PARTICLES particles ---"
+	./main-bench -t 1 -q -w bench-snapshot.bwld | grep snapshot
+	./main-bench -t 0 -q -l bench-snapshot.bwld | grep snapshot
+
+done
+
+rm -f bench-snapshot.bwld
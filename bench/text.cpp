@@ -0,0 +1,84 @@
+//compares the cost of preparing a hud of changing numbers with the old per string rasterization and with the glyph atlas
+//build and run from the repository root with bench/text.sh
+
+#include "engine/text.h"
+#include "engine/geometry.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+int NUMBER_OF_STRINGS = 300;
+int NUMBER_OF_FRAMES = 100;
+int FONT_SIZE = 12;
+
+double getTimeMilliseconds(){
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+
+}
+
+int main(){
+
+	Font font = getFont("assets/fonts/times.ttf", FONT_SIZE);
+
+	double startTime = getTimeMilliseconds();
+
+	FontAtlas atlas;
+	FontAtlas_init(&atlas, &font);
+
+	printf("atlas init: %.3f ms (%ix%i)\n", getTimeMilliseconds() - startTime, atlas.width, atlas.height);
+
+	char text[64];
+
+	//old path, one rasterized image per string
+	startTime = getTimeMilliseconds();
+
+	for(int frame = 0; frame < NUMBER_OF_FRAMES; frame++){
+		for(int i = 0; i < NUMBER_OF_STRINGS; i++){
+
+			sprintf(text, "value %i: %.3f", i, frame * 0.1 + i);
+
+			int width, height;
+			char *data = getImageDataFromFontAndString_mustFree(font, text, &width, &height);
+
+			free(data);
+
+		}
+	}
+
+	printf("rasterize: %.3f ms per frame\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_FRAMES);
+
+	//atlas path, quads for all strings
+	std::vector<TextQuad> quads;
+	int numberOfQuads = 0;
+
+	startTime = getTimeMilliseconds();
+
+	for(int frame = 0; frame < NUMBER_OF_FRAMES; frame++){
+
+		quads.clear();
+
+		for(int i = 0; i < NUMBER_OF_STRINGS; i++){
+
+			sprintf(text, "value %i: %.3f", i, frame * 0.1 + i);
+
+			FontAtlas_addTextQuads(&atlas, text, 0.0, i * FONT_SIZE, &quads);
+
+		}
+
+		numberOfQuads = quads.size();
+
+	}
+
+	printf("atlas: %.3f ms per frame (%i quads)\n", (getTimeMilliseconds() - startTime) / NUMBER_OF_FRAMES, numberOfQuads);
+
+	FontAtlas_free(&atlas);
+
+	return 0;
+
+}
@@ -0,0 +1,6 @@
+#rasterizing every string with stb_truetype versus laying it out from a glyph atlas
+#run from the repository root: sh bench/text.sh
+
+g++ bench/text.cpp lib/engine/text.cpp lib/engine/geometry.cpp -O2 -I ./include/ -lm -o bench-text || exit 1
+
+./bench-text
@@ -3,6 +3,7 @@
 
 #include "engine/geometry.h"
 #include "engine/strings.h"
+#include "engine/mesh.h"
 
 #include "glad/wgl.h"
 #include "glad/gl.h"
@@ -14,11 +15,21 @@ typedef struct Model{
 	unsigned int VBO;
 	unsigned int VAO;
 	unsigned int numberOfTriangles;
+	//models loaded from .imesh files are drawn with an index buffer, numberOfIndices is 0 for the others
+	unsigned int EBO;
+	unsigned int numberOfIndices;
+	unsigned int indexType;
+	//models with compact vertices have positions within 0 to 1 of these bounds, see Model_getPositionMatrix
+	enum MeshVertexFormat vertexFormat;
+	Vec3f boundsMin;
+	Vec3f boundsSize;
 }Model;
 
 typedef struct Texture{
 	char name[STRING_SIZE];
 	unsigned int ID;
+	int width;
+	int height;
 }Texture;
 
 typedef struct VertexMesh{
@@ -28,30 +39,71 @@ typedef struct VertexMesh{
 
 void Model_initFromMeshData(Model *, const unsigned char *, int);
 
-void Model_initFromFile_mesh(Model *, const char *);
+void Model_initFromIndexedMeshView(Model *, IndexedMeshView *);
+
+Mat4f Model_getPositionMatrix(Model *);
+
+void VertexMesh_initFromMeshData(VertexMesh *, const unsigned char *, int);
+
+void Model_initFromFile_mesh(Model *, VertexMesh *, const char *);
 
 void VertexMesh_initFromFile_mesh(VertexMesh *, const char *);
 
+void Model_initFromFile_indexedMesh(Model *, VertexMesh *, const char *);
+
+void Model_draw(Model *);
+
+void Model_free(Model *);
+
+void VertexMesh_free(VertexMesh *);
+
 void Texture_init(Texture *, const char *, unsigned char *, int, int);
 
 void Texture_initFromFile(Texture *, const char *, const char *);
 
+void Texture_initEmpty(Texture *, const char *, int, int);
+
+void Texture_updateRegion(Texture *, unsigned char *, int, int, int, int, int);
+
 void Texture_free(Texture *);
 
+//number of GL calls made by the GL3D, Texture and Renderer2D functions, the engine loop reports and resets it every frame
+extern int GL3D_numberOfDriverCalls;
+
+int GL3D_getUniformLocation(unsigned int, const char *);
+
+//the AtLocation functions take a location from GL3D_getUniformLocation, so shaders can look their locations up once when they are set up
+
+void GL3D_uniformMat2fAtLocation(int, Mat2f);
+
 void GL3D_uniformMat2f(unsigned int, const char *, Mat2f);
 
+void GL3D_uniformMat4fAtLocation(int, Mat4f);
+
 void GL3D_uniformMat4f(unsigned int, const char *, Mat4f);
 
+void GL3D_uniformVec2fAtLocation(int, Vec2f);
+
 void GL3D_uniformVec2f(unsigned int, const char *, Vec2f);
 
+void GL3D_uniformVec3fAtLocation(int, Vec3f);
+
 void GL3D_uniformVec3f(unsigned int, const char *, Vec3f);
 
+void GL3D_uniformVec4fAtLocation(int, Vec4f);
+
 void GL3D_uniformVec4f(unsigned int, const char *, Vec4f);
 
+void GL3D_uniformIntAtLocation(int, int);
+
 void GL3D_uniformInt(unsigned int, const char *, int);
 
+void GL3D_uniformFloatAtLocation(int, float);
+
 void GL3D_uniformFloat(unsigned int, const char *, float);
 
+void GL3D_uniformTextureAtLocation(int, unsigned int, unsigned int);
+
 void GL3D_uniformTexture(unsigned int, const char *, unsigned int, unsigned int);
 
 #endif
@@ -0,0 +1,19 @@
+#ifndef COMPRESSION_H_
+#define COMPRESSION_H_
+
+#include <vector>
+
+/*
+Run length encoding for data that is mostly long spans of the same byte, like the material grid.
+Each run is stored as two bytes, the length of the run minus one and the byte, so runs are at most 256 bytes long.
+*/
+
+#define RUN_LENGTH_MAX_RUN 256
+
+//appends the encoded data to the vector
+void RunLength_encode(std::vector<unsigned char> *, const unsigned char *, int);
+
+//decodes exactly the given number of bytes, returns the number of encoded bytes read or -1 if the encoded data is too short or too long
+int RunLength_decode(unsigned char *, int, const unsigned char *, int);
+
+#endif
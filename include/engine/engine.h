@@ -135,18 +135,40 @@ extern int Engine_elapsedFrames;
 
 extern bool Engine_fpsModeOn;
 
+//Engine_update is called this many times per second however fast frames are drawn
+extern int Engine_updatesPerSecond;
+
+//frames are drawn at most this many times per second, on Linux
+extern int Engine_framesPerSecond;
+
+extern bool Engine_isHeadless;
+
 //ENGINE FUNCTIONS
 
 void Engine_start();
 
+//the time is in updates, so with the fixed timestep it is always one update of 1 / Engine_updatesPerSecond seconds
 void Engine_update(float);
 
-void Engine_draw();
+//alpha is how far the frame is between the last update and the next one, from 0 to 1
+void Engine_draw(float);
 
 void Engine_finnish();
 
+//a hash of the simulation state, used to check that replaying the same input gives the same result
+unsigned long long Engine_getStateHash();
+
+//saves the state Engine_getStateHash covers to a file and loads it back, both return false and print why on failure
+bool Engine_saveSnapshot(const char *);
+
+bool Engine_loadSnapshot(const char *);
+
 void Engine_quit();
 
+//TIME FUNCTIONS
+
+long long Engine_getTimeNanoseconds();
+
 //WINDOW FUNCTIONS
 
 void Engine_setFPSMode(bool);
@@ -3,12 +3,40 @@
 
 #include "engine/strings.h"
 
+#include "stdio.h"
+
 typedef char FileLine[STRING_SIZE];
 
+//a read only view of a whole file, mapped into memory when the platform allows it, has to be released with FileView_release
+typedef struct FileView{
+	const char *data;
+	long int size;
+	bool mapped;
+}FileView;
+
+//writes through a large buffer to a temporary file that replaces the file at path in FileWriter_finish, so a failed write never leaves half a file behind
+typedef struct FileWriter{
+	FILE *file_p;
+	char *buffer;
+	char path[STRING_SIZE];
+	char temporaryPath[STRING_SIZE];
+	bool failed;
+}FileWriter;
+
+bool FileView_init(FileView *, const char *);
+
+void FileView_release(FileView *);
+
 char *getFileData_mustFree(const char *, long int *);
 
 FileLine *getFileLines_mustFree(const char *, int *);
 
-void writeDataToFile(const char *, char *, long int);
+bool FileWriter_init(FileWriter *, const char *);
+
+void FileWriter_write(FileWriter *, const void *, long int);
+
+bool FileWriter_finish(FileWriter *);
+
+bool writeDataToFile(const char *, const char *, long int);
 
 #endif
@@ -0,0 +1,15 @@
+#ifndef JOBS_H_
+#define JOBS_H_
+
+//function run for the range [start, end) on the worker with index threadIndex
+typedef void (*JobFunction)(void *, int, int, int);
+
+void JobSystem_init(int);
+
+void JobSystem_finnish();
+
+int JobSystem_getNumberOfThreads();
+
+void JobSystem_parallelFor(int, int, JobFunction, void *);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef MESH_H_
+#define MESH_H_
+
+#include "stddef.h"
+#include <vector>
+
+//vertices in both mesh formats are interleaved position, texture coordinate and normal
+#define MESH_VERTEX_FLOATS 8
+#define MESH_VERTEX_SIZE (MESH_VERTEX_FLOATS * sizeof(float))
+#define MESH_TRIANGLE_SIZE (3 * MESH_VERTEX_SIZE)
+
+//.imesh files start with this header, followed by the vertices and then the indices, which are 2 or 4 bytes each
+#define INDEXED_MESH_MAGIC "IMSH"
+#define INDEXED_MESH_VERSION 2
+
+enum MeshVertexFormat{
+	MESH_VERTEX_FORMAT_FLOAT,
+	MESH_VERTEX_FORMAT_COMPACT,
+};
+
+typedef struct IndexedMeshHeader{
+	char magic[4];
+	unsigned int version;
+	unsigned int numberOfVertices;
+	unsigned int numberOfIndices;
+	unsigned int indexSize;
+	//version 1 files end the header here and always have float vertices
+	unsigned int vertexFormat;
+	float boundsMin[3];
+	float boundsSize[3];
+}IndexedMeshHeader;
+
+#define INDEXED_MESH_VERSION_1_HEADER_SIZE offsetof(IndexedMeshHeader, vertexFormat)
+
+//half the size of a float vertex, the position is normalized within the bounds of the mesh, the texture coordinate within 0 to 1 and the normal is packed 10-10-10-2
+typedef struct CompactMeshVertex{
+	unsigned short position[4];
+	unsigned short textureCoord[2];
+	unsigned int normal;
+}CompactMeshVertex;
+
+//points into the data of an .imesh file without copying it
+typedef struct IndexedMeshView{
+	IndexedMeshHeader header;
+	const void *vertices;
+	const void *indices;
+}IndexedMeshView;
+
+typedef struct IndexedMesh{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+}IndexedMesh;
+
+//post transform cache behaviour of an index buffer, ACMR is transformed vertices per triangle and ATVR transformed vertices per vertex, 1.0 is the best possible ATVR
+typedef struct MeshCacheStats{
+	float ACMR;
+	float ATVR;
+}MeshCacheStats;
+
+//largest differences between the float and compact vertices, the position error is relative to the largest side of the bounds
+typedef struct MeshQuantizationError{
+	float position;
+	float textureCoord;
+	float normalDegrees;
+}MeshQuantizationError;
+
+void IndexedMesh_initFromMeshData(IndexedMesh *, const unsigned char *, int);
+
+int IndexedMesh_getNumberOfVertices(IndexedMesh *);
+
+int IndexedMesh_getIndexSize(IndexedMesh *);
+
+bool IndexedMesh_canUseCompactVertices(IndexedMesh *);
+
+void IndexedMesh_getCompactVertices(IndexedMesh *, std::vector<CompactMeshVertex> *, float *, float *);
+
+MeshQuantizationError IndexedMesh_getQuantizationError(IndexedMesh *);
+
+bool IndexedMesh_writeToFile(IndexedMesh *, const char *, enum MeshVertexFormat);
+
+void IndexedMesh_optimizeVertexCache(IndexedMesh *);
+
+void IndexedMesh_optimizeVertexFetch(IndexedMesh *);
+
+MeshCacheStats IndexedMesh_getCacheStats(IndexedMesh *, int);
+
+bool IndexedMeshView_init(IndexedMeshView *, const char *, long int);
+
+int IndexedMeshView_getVertexSize(IndexedMeshView *);
+
+unsigned int IndexedMeshView_getIndex(IndexedMeshView *, int);
+
+void IndexedMeshView_getPosition(IndexedMeshView *, int, float *);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PARTICLES_H_
+#define PARTICLES_H_
+
+#include "engine/geometry.h"
+
+#include "stddef.h"
+#include <vector>
+
+//particle state kept as separate arrays per component, indexed by axis, so the hot loops run over contiguous floats
+typedef struct Particles{
+	int length;
+	std::vector<size_t> IDs;
+	std::vector<float> pos[2];
+	std::vector<float> lastPos[2];
+	std::vector<float> velocity[2];
+}Particles;
+
+typedef struct ParticleForces{
+	float gravity;
+	float resistance;
+	bool bending;
+	Vec2f bendingPos;
+	float bendingForce;
+}ParticleForces;
+
+void Particles_init(Particles *);
+
+void Particles_add(Particles *, size_t, Vec2f);
+
+Vec2f Particles_getPos(Particles *, int);
+
+Vec2f Particles_getLastPos(Particles *, int);
+
+void Particles_setPos(Particles *, int, Vec2f);
+
+void Particles_removeMarked(Particles *, std::vector<char> *);
+
+void Particles_integrate(Particles *, ParticleForces);
+
+void Particles_integrate_scalar(Particles *, ParticleForces, int, int);
+
+void Particles_integrate_simd(Particles *, ParticleForces, int, int);
+
+#endif
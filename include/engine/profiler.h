@@ -0,0 +1,28 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+//records the time from where it is declared to the end of the scope as a zone, the name has to be a string literal
+typedef struct Profiler_Zone{
+	const char *name;
+	long long startTime;
+
+	Profiler_Zone(const char *);
+	~Profiler_Zone();
+}Profiler_Zone;
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+#define PROFILER_ZONE(name) Profiler_Zone PROFILER_CONCAT(profilerZone_, __LINE__)(name)
+
+//adds to a value that is reported per frame like the zones, only call it from the thread that ends the frames
+void Profiler_count(const char *, long long);
+
+void Profiler_beginFrame();
+
+void Profiler_endFrame();
+
+void Profiler_printReport();
+
+void Profiler_writeChromeTrace(const char *);
+
+#endif
@@ -6,6 +6,25 @@
 #include "engine/geometry.h"
 #include "engine/3d.h"
 
+//one rectangle in the instance buffer, rectangle holds the center and size in the units the vertex shaders use
+typedef struct Renderer2D_RectangleInstance{
+	Vec4f rectangle;
+	Vec4f color;
+	Vec4f textureRegion;
+	float rotation;
+}Renderer2D_RectangleInstance;
+
+//uniform locations of a shader that is not one of the built in ones, looked up with the GL3D location cache
+typedef struct Renderer2D_ShaderUniformLocations{
+	int posX;
+	int posY;
+	int width;
+	int height;
+	int aspectRatio;
+	int rotationMatrix;
+	int color;
+}Renderer2D_ShaderUniformLocations;
+
 typedef struct Renderer2D_Renderer{
 	int width;
 	int height;
@@ -17,17 +36,45 @@ typedef struct Renderer2D_Renderer{
 
 	unsigned int textureShader;
 	unsigned int colorShader;
+	//draws the current color with the alpha of the current texture, used for font atlases
+	unsigned int textShader;
 	unsigned int currentShader;
 
+	Renderer2D_ShaderUniformLocations currentUniformLocations;
+	std::vector<unsigned int> customShaders;
+	std::vector<Renderer2D_ShaderUniformLocations> customShaderUniformLocations;
+
+	//rectangles drawn with textureShader or colorShader are drawn as instances with these shaders instead
+	unsigned int instancedTextureShader;
+	unsigned int instancedColorShader;
+	unsigned int instanceVBO;
+	unsigned int instanceVAO;
+	int instanceBufferSize;
+	std::vector<Renderer2D_RectangleInstance> instances;
+
+	bool batching;
+	Vec4f color;
+	float rotation;
+	unsigned int currentTextureID;
+
+	std::vector<TextQuad> textQuads;
+
 	bool drawAroundCenter;
 }Renderer2D_Renderer;
 
+typedef struct Renderer2D_Font{
+	FontAtlas atlas;
+	Texture texture;
+}Renderer2D_Font;
+
 //INIT FUNCTIONS
 
 void Renderer2D_init(Renderer2D_Renderer *, int, int);
 
 void Texture_initFromText(Texture *, const char *, Font);
 
+void Renderer2D_Font_init(Renderer2D_Font *, const char *, int);
+
 //SETTINGS FUNCTIONS
 
 void Renderer2D_updateDrawSize(Renderer2D_Renderer *, int, int);
@@ -48,6 +95,18 @@ void Renderer2D_setRotation(Renderer2D_Renderer *, float);
 
 void Renderer2D_drawRectangle(Renderer2D_Renderer *, float, float, float, float);
 
-void Renderer2D_drawText(Renderer2D_Renderer *, const char *, float, float, int, Font, float);
+void Renderer2D_drawTextureRegion(Renderer2D_Renderer *, float, float, float, float, Vec4f);
+
+//BATCHING FUNCTIONS
+
+void Renderer2D_beginBatch(Renderer2D_Renderer *);
+
+void Renderer2D_flush(Renderer2D_Renderer *);
+
+void Renderer2D_endBatch(Renderer2D_Renderer *);
+
+//TEXT FUNCTIONS
+
+void Renderer2D_drawText(Renderer2D_Renderer *, const char *, float, float, Renderer2D_Font *);
 
 #endif
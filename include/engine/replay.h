@@ -0,0 +1,51 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+/*
+Input logs hold the input state Engine_update saw on every tick where it was not the same as on the tick before.
+The file is a header followed by records, each record is followed by the text input of that tick.
+*/
+
+#define INPUT_LOG_MAGIC "INPL"
+#define INPUT_LOG_VERSION 1
+
+typedef struct InputLogHeader{
+	char magic[4];
+	unsigned int version;
+	unsigned int numberOfKeys;
+	unsigned int numberOfTicks;
+}InputLogHeader;
+
+typedef struct InputLogRecord{
+	unsigned long long keysDown;
+	unsigned long long keysDowned;
+	unsigned long long keysUpped;
+	float pointerPos[2];
+	float pointerMovement[2];
+	float pointerLastDownedPos[2];
+	float pointerLastUppedPos[2];
+	unsigned int tick;
+	unsigned char pointerFlags;
+	unsigned char textInputLength;
+	unsigned short padding;
+}InputLogRecord;
+
+//RECORDING FUNCTIONS
+
+bool InputRecorder_start(const char *);
+
+bool InputRecorder_isRecording();
+
+void InputRecorder_recordTick(int);
+
+void InputRecorder_stop();
+
+//REPLAY FUNCTIONS
+
+bool InputReplay_load(const char *);
+
+int InputReplay_getNumberOfTicks();
+
+void InputReplay_applyTick(int);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SPATIALHASH_H_
+#define SPATIALHASH_H_
+
+#include "engine/geometry.h"
+
+#include <vector>
+
+/*
+A uniform grid of square cells where each cell is hashed into one of a fixed number of buckets, so the grid needs no bounds.
+Items are boxes identified by the order they were added in. The hash is rebuilt by clearing it, adding every box and calling SpatialHash_build,
+which sorts the items into their buckets with a counting sort, so building and querying never allocate once the vectors have grown.
+*/
+
+typedef struct SpatialHash{
+	float cellSize;
+	int numberOfBuckets;
+	std::vector<Vec2f> itemPositions;
+	std::vector<Vec2f> itemSizes;
+	std::vector<int> bucketStarts;
+	std::vector<int> bucketItems;
+	std::vector<int> bucketEnds;
+	std::vector<unsigned int> itemQueryStamps;
+	unsigned int queryStamp;
+}SpatialHash;
+
+//the number of buckets has to be a power of 2
+void SpatialHash_init(SpatialHash *, float, int);
+
+void SpatialHash_clear(SpatialHash *);
+
+//returns the index of the item
+int SpatialHash_add(SpatialHash *, Vec2f, Vec2f);
+
+void SpatialHash_build(SpatialHash *);
+
+//appends the items whose boxes overlap the box, in the order they were added
+void SpatialHash_queryBox(SpatialHash *, Vec2f, Vec2f, std::vector<int> *);
+
+//appends the items whose boxes overlap the circle, in the order they were added
+void SpatialHash_queryRadius(SpatialHash *, Vec2f, float, std::vector<int> *);
+
+#endif
@@ -1,8 +1,12 @@
 #ifndef TEXT_H_
 #define TEXT_H_
 
+#include "engine/geometry.h"
+
 #include "stb/stb_truetype.h"
 
+#include <vector>
+
 typedef struct Glyph{
 
 	unsigned char *data;
@@ -37,8 +41,50 @@ typedef struct Font{
 
 }Font;
 
+//printable ASCII characters are put in the atlas, other characters are drawn as spaces
+#define FONT_ATLAS_FIRST_CHARACTER 32
+#define FONT_ATLAS_NUMBER_OF_CHARACTERS 95
+
+typedef struct AtlasGlyph{
+	Vec4f textureRegion;
+	int offsetX;
+	int offsetY;
+	int width;
+	int height;
+	float advance;
+}AtlasGlyph;
+
+//all glyphs of a font at one size rasterized once into an RGBA image, with coverage in the alpha channel
+typedef struct FontAtlas{
+	int size;
+	int ascent;
+	int descent;
+	int lineGap;
+	int width;
+	int height;
+	unsigned char *data;
+	AtlasGlyph glyphs[FONT_ATLAS_NUMBER_OF_CHARACTERS];
+	float kerning[FONT_ATLAS_NUMBER_OF_CHARACTERS][FONT_ATLAS_NUMBER_OF_CHARACTERS];
+}FontAtlas;
+
+typedef struct TextQuad{
+	float x;
+	float y;
+	float width;
+	float height;
+	Vec4f textureRegion;
+}TextQuad;
+
 Font getFont(const char *, int);
 
+void FontAtlas_init(FontAtlas *, Font *);
+
+void FontAtlas_free(FontAtlas *);
+
+float FontAtlas_getTextWidth(FontAtlas *, const char *);
+
+void FontAtlas_addTextQuads(FontAtlas *, const char *, float, float, std::vector<TextQuad> *);
+
 char *getImageDataFromFontAndString_mustFree(Font, const char *, int *, int *);
 
 #endif
@@ -1,6 +1,7 @@
 #include "engine/geometry.h"
 #include "engine/files.h"
 #include "engine/3d.h"
+#include "engine/mesh.h"
 
 #define STB_IMAGE_STATIC
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,23 +16,49 @@
 #include "stdlib.h"
 #include <vector>
 
-typedef struct Face{
-	unsigned int indices[9];
-}Face;
+typedef struct UniformLocation{
+	unsigned int shaderProgram;
+	char name[SMALL_STRING_SIZE];
+	int location;
+}UniformLocation;
 
-void Model_initFromMeshData(Model *model_p, const unsigned char *mesh, int numberOfTriangles){
+int GL3D_numberOfDriverCalls = 0;
+
+//uniform locations are only asked from the driver the first time, shader programs are never deleted so they stay valid
+static std::vector<UniformLocation> uniformLocations;
+
+//.mesh files are a list of triangles, see mesh.h for the vertex layouts
+static void initModelVertexArray(Model *model_p, const unsigned char *vertices, int numberOfVertices, enum MeshVertexFormat vertexFormat){
 
-	//printf("%i\n", numberOfTriangles);
+	model_p->vertexFormat = vertexFormat;
+	model_p->boundsMin = getVec3f(0.0, 0.0, 0.0);
+	model_p->boundsSize = getVec3f(1.0, 1.0, 1.0);
 
-	int componentSize = 2 * sizeof(Vec3f) + sizeof(Vec2f);
+	int vertexSize = vertexFormat == MESH_VERTEX_FORMAT_COMPACT ? sizeof(CompactMeshVertex) : MESH_VERTEX_SIZE;
 
 	glGenBuffers(1, &model_p->VBO);
 	glBindBuffer(GL_ARRAY_BUFFER, model_p->VBO);
-	glBufferData(GL_ARRAY_BUFFER, componentSize * 3 * numberOfTriangles, mesh, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, numberOfVertices * vertexSize, vertices, GL_STATIC_DRAW);
 
 	glGenVertexArrays(1, &model_p->VAO);
 	glBindVertexArray(model_p->VAO);
 
+	//the shaders see the same vec3 position, vec2 texture coordinate and vec3 normal for both layouts, except that compact positions are within 0 to 1 of the bounds
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactMeshVertex), (void *)offsetof(CompactMeshVertex, position));
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactMeshVertex), (void *)offsetof(CompactMeshVertex, textureCoord));
+		glEnableVertexAttribArray(1);
+
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactMeshVertex), (void *)offsetof(CompactMeshVertex, normal));
+		glEnableVertexAttribArray(2);
+
+		return;
+
+	}
+
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
 	glEnableVertexAttribArray(0);
 
@@ -41,53 +68,215 @@ void Model_initFromMeshData(Model *model_p, const unsigned char *mesh, int numbe
 	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(5 * sizeof(float)));
 	glEnableVertexAttribArray(2);
 
+}
+
+void Model_initFromMeshData(Model *model_p, const unsigned char *mesh, int numberOfTriangles){
+
+	initModelVertexArray(model_p, mesh, numberOfTriangles * 3, MESH_VERTEX_FORMAT_FLOAT);
+
+	model_p->EBO = 0;
+	model_p->numberOfIndices = 0;
+	model_p->indexType = 0;
+
 	model_p->numberOfTriangles = numberOfTriangles;
 
 }
 
-void Model_initFromFile_mesh(Model *model_p, const char *path){
+//the index buffer is bound to the vertex array, so Model_draw only has to bind the vertex array
+void Model_initFromIndexedMeshView(Model *model_p, IndexedMeshView *indexedMeshView_p){
+
+	IndexedMeshHeader *header_p = &indexedMeshView_p->header;
 
-	long int fileSize;
-	char *data = getFileData_mustFree(path, &fileSize);
+	initModelVertexArray(model_p, (const unsigned char *)indexedMeshView_p->vertices, header_p->numberOfVertices, (enum MeshVertexFormat)header_p->vertexFormat);
+
+	if(header_p->vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+		model_p->boundsMin = getVec3f(header_p->boundsMin[0], header_p->boundsMin[1], header_p->boundsMin[2]);
+		model_p->boundsSize = getVec3f(header_p->boundsSize[0], header_p->boundsSize[1], header_p->boundsSize[2]);
+	}
 
-	int numberOfTriangles = fileSize / (sizeof(float) * 8 * 3);
+	glGenBuffers(1, &model_p->EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model_p->EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, header_p->numberOfIndices * header_p->indexSize, indexedMeshView_p->indices, GL_STATIC_DRAW);
 
-	Model_initFromMeshData(model_p, (unsigned char *)data, numberOfTriangles);
+	glBindVertexArray(0);
+
+	model_p->numberOfIndices = header_p->numberOfIndices;
+	model_p->indexType = header_p->indexSize == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	model_p->numberOfTriangles = header_p->numberOfIndices / 3;
 
 }
 
-void VertexMesh_initFromFile_mesh(VertexMesh *vertexMesh_p, const char *path){
+//transforms the positions the vertex shader gets into model space, multiply the model matrix by this for models with compact vertices
+Mat4f Model_getPositionMatrix(Model *model_p){
+
+	if(model_p->vertexFormat != MESH_VERTEX_FORMAT_COMPACT){
+		return getIdentityMat4f();
+	}
 
-	long int fileSize;
-	char *data = getFileData_mustFree(path, &fileSize);
+	Mat4f positionMatrix = {
+		model_p->boundsSize.x, 0, 0, model_p->boundsMin.x,
+		0, model_p->boundsSize.y, 0, model_p->boundsMin.y,
+		0, 0, model_p->boundsSize.z, model_p->boundsMin.z,
+		0, 0, 0, 1,
+	};
 
-	int numberOfTriangles = fileSize / (sizeof(float) * 8 * 3);
+	return positionMatrix;
+
+}
+
+//copies only the positions out of the interleaved vertices
+void VertexMesh_initFromMeshData(VertexMesh *vertexMesh_p, const unsigned char *mesh, int numberOfTriangles){
 
 	vertexMesh_p->length = numberOfTriangles * 3;
 	vertexMesh_p->vertices = (Vec3f *)malloc(vertexMesh_p->length * sizeof(Vec3f));
-	
-	for(int i = 0; i < numberOfTriangles * 3; i++){
-		
-		memcpy(vertexMesh_p->vertices + i, data + i * 8 * sizeof(float), sizeof(Vec3f));
+
+	const float *meshFloats = (const float *)mesh;
+	float *positions = (float *)vertexMesh_p->vertices;
+
+	for(int i = 0; i < vertexMesh_p->length; i++){
+		positions[i * 3 + 0] = meshFloats[i * MESH_VERTEX_FLOATS + 0];
+		positions[i * 3 + 1] = meshFloats[i * MESH_VERTEX_FLOATS + 1];
+		positions[i * 3 + 2] = meshFloats[i * MESH_VERTEX_FLOATS + 2];
+	}
+
+}
+
+static bool getMeshFileView(FileView *fileView_p, const char *path, int *numberOfTriangles_out){
+
+	if(!FileView_init(fileView_p, path)){
+		return false;
+	}
+
+	if(fileView_p->size % MESH_TRIANGLE_SIZE != 0){
+		printf("Mesh file does not contain whole triangles: %s\n", path);
+	}
+
+	*numberOfTriangles_out = fileView_p->size / MESH_TRIANGLE_SIZE;
+
+	return true;
+
+}
+
+//uploads the mesh straight from the mapped file, pass NULL for either output to skip it
+void Model_initFromFile_mesh(Model *model_p, VertexMesh *vertexMesh_p, const char *path){
+
+	FileView fileView;
+	int numberOfTriangles;
+
+	if(!getMeshFileView(&fileView, path, &numberOfTriangles)){
+		return;
+	}
+
+	if(model_p != NULL){
+
+		String_set(model_p->name, path, STRING_SIZE);
+
+		Model_initFromMeshData(model_p, (const unsigned char *)fileView.data, numberOfTriangles);
+
+	}
+
+	if(vertexMesh_p != NULL){
+		VertexMesh_initFromMeshData(vertexMesh_p, (const unsigned char *)fileView.data, numberOfTriangles);
+	}
+
+	FileView_release(&fileView);
+
+}
+
+void VertexMesh_initFromFile_mesh(VertexMesh *vertexMesh_p, const char *path){
+	Model_initFromFile_mesh(NULL, vertexMesh_p, path);
+}
+
+//loads an .imesh file written by tools/convert-mesh.sh, the vertex mesh gets the positions of every triangle like with .mesh files
+void Model_initFromFile_indexedMesh(Model *model_p, VertexMesh *vertexMesh_p, const char *path){
+
+	FileView fileView;
+
+	if(!FileView_init(&fileView, path)){
+		return;
+	}
+
+	IndexedMeshView indexedMeshView;
+
+	if(!IndexedMeshView_init(&indexedMeshView, fileView.data, fileView.size)){
+		printf("Could not load indexed mesh: %s\n", path);
+		FileView_release(&fileView);
+		return;
+	}
+
+	IndexedMeshHeader *header_p = &indexedMeshView.header;
+
+	if(model_p != NULL){
+
+		String_set(model_p->name, path, STRING_SIZE);
+
+		Model_initFromIndexedMeshView(model_p, &indexedMeshView);
+
+	}
+
+	if(vertexMesh_p != NULL){
+
+		vertexMesh_p->length = header_p->numberOfIndices;
+		vertexMesh_p->vertices = (Vec3f *)malloc(vertexMesh_p->length * sizeof(Vec3f));
+
+		for(int i = 0; i < vertexMesh_p->length; i++){
+			IndexedMeshView_getPosition(&indexedMeshView, IndexedMeshView_getIndex(&indexedMeshView, i), (float *)(vertexMesh_p->vertices + i));
+		}
 
 	}
 
+	FileView_release(&fileView);
+
+}
+
+//binds the model's vertex array and draws it with the current shader
+void Model_draw(Model *model_p){
+
+	glBindVertexArray(model_p->VAO);
+
+	if(model_p->numberOfIndices > 0){
+		glDrawElements(GL_TRIANGLES, model_p->numberOfIndices, model_p->indexType, 0);
+	}else{
+		glDrawArrays(GL_TRIANGLES, 0, model_p->numberOfTriangles * 3);
+	}
+
+	GL3D_numberOfDriverCalls += 2;
+
+}
+
+void Model_free(Model *model_p){
+	glDeleteVertexArrays(1, &model_p->VAO);
+	glDeleteBuffers(1, &model_p->VBO);
+
+	if(model_p->EBO != 0){
+		glDeleteBuffers(1, &model_p->EBO);
+	}
+}
+
+void VertexMesh_free(VertexMesh *vertexMesh_p){
+	free(vertexMesh_p->vertices);
+	vertexMesh_p->vertices = NULL;
+	vertexMesh_p->length = 0;
 }
 
 void Texture_init(Texture *texture_p, const char *name, unsigned char *data, int width, int height){
 
 	String_set(texture_p->name, name, SMALL_STRING_SIZE);
 
+	texture_p->width = width;
+	texture_p->height = height;
+
 	glGenTextures(1, &texture_p->ID);
 
 	glBindTexture(GL_TEXTURE_2D, texture_p->ID);
 
+	//no mipmaps are generated since the texture is only sampled with nearest filtering
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 
-	glGenerateMipmap(GL_TEXTURE_2D);
-
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 
 }
 
@@ -102,70 +291,154 @@ void Texture_initFromFile(Texture *texture_p, const char *path, const char *name
 
 }
 
+//allocates storage for a texture that is filled later with Texture_updateRegion
+void Texture_initEmpty(Texture *texture_p, const char *name, int width, int height){
+
+	Texture_init(texture_p, name, NULL, width, height);
+
+}
+
+//uploads the width * height region at x, y from an RGBA image that is dataWidth pixels wide and has the same layout as the texture
+void Texture_updateRegion(Texture *texture_p, unsigned char *data, int dataWidth, int x, int y, int width, int height){
+
+	glBindTexture(GL_TEXTURE_2D, texture_p->ID);
+
+	GL3D_numberOfDriverCalls += 8;
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, dataWidth);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, x);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, y);
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+}
+
 void Texture_free(Texture *texture_p){
 	glDeleteTextures(1, &texture_p->ID);
 }
 
-void GL3D_uniformMat2f(unsigned int shaderProgram, const char *locationName, Mat2f m){
+int GL3D_getUniformLocation(unsigned int shaderProgram, const char *locationName){
+
+	for(int i = 0; i < uniformLocations.size(); i++){
+		if(uniformLocations[i].shaderProgram == shaderProgram
+		&& strcmp(uniformLocations[i].name, locationName) == 0){
+			return uniformLocations[i].location;
+		}
+	}
+
+	UniformLocation uniformLocation;
+	uniformLocation.shaderProgram = shaderProgram;
+	String_set(uniformLocation.name, locationName, SMALL_STRING_SIZE);
+	uniformLocation.location = glGetUniformLocation(shaderProgram, locationName);
+
+	GL3D_numberOfDriverCalls++;
+
+	uniformLocations.push_back(uniformLocation);
+
+	return uniformLocation.location;
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+}
+
+//the functions taking a location are for locations looked up once when a shader is set up, the ones taking a name look it up in the cache on every call
+
+void GL3D_uniformMat2fAtLocation(int location, Mat2f m){
+
+	GL3D_numberOfDriverCalls++;
 
 	glUniformMatrix2fv(location, 1, GL_FALSE, (float *)m.values);
 
 }
 
-void GL3D_uniformMat4f(unsigned int shaderProgram, const char *locationName, Mat4f m){
+void GL3D_uniformMat2f(unsigned int shaderProgram, const char *locationName, Mat2f m){
+	GL3D_uniformMat2fAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), m);
+}
+
+void GL3D_uniformMat4fAtLocation(int location, Mat4f m){
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+	GL3D_numberOfDriverCalls++;
 
 	glUniformMatrix4fv(location, 1, GL_FALSE, (float *)m.values);
 
 }
 
-void GL3D_uniformVec2f(unsigned int shaderProgram, const char *locationName, Vec2f v){
+void GL3D_uniformMat4f(unsigned int shaderProgram, const char *locationName, Mat4f m){
+	GL3D_uniformMat4fAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), m);
+}
+
+void GL3D_uniformVec2fAtLocation(int location, Vec2f v){
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+	GL3D_numberOfDriverCalls++;
 
 	glUniform2f(location, v.x, v.y);
 
 }
 
-void GL3D_uniformVec3f(unsigned int shaderProgram, const char *locationName, Vec3f v){
+void GL3D_uniformVec2f(unsigned int shaderProgram, const char *locationName, Vec2f v){
+	GL3D_uniformVec2fAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), v);
+}
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+void GL3D_uniformVec3fAtLocation(int location, Vec3f v){
+
+	GL3D_numberOfDriverCalls++;
 
 	glUniform3f(location, v.x, v.y, v.z);
 
 }
 
-void GL3D_uniformVec4f(unsigned int shaderProgram, const char *locationName, Vec4f v){
+void GL3D_uniformVec3f(unsigned int shaderProgram, const char *locationName, Vec3f v){
+	GL3D_uniformVec3fAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), v);
+}
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+void GL3D_uniformVec4fAtLocation(int location, Vec4f v){
+
+	GL3D_numberOfDriverCalls++;
 
 	glUniform4f(location, v.x, v.y, v.z, v.w);
 
 }
 
-void GL3D_uniformInt(unsigned int shaderProgram, const char *locationName, int x){
+void GL3D_uniformVec4f(unsigned int shaderProgram, const char *locationName, Vec4f v){
+	GL3D_uniformVec4fAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), v);
+}
+
+void GL3D_uniformIntAtLocation(int location, int x){
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+	GL3D_numberOfDriverCalls++;
 
 	glUniform1i(location, x);
 
 }
 
-void GL3D_uniformFloat(unsigned int shaderProgram, const char *locationName, float x){
+void GL3D_uniformInt(unsigned int shaderProgram, const char *locationName, int x){
+	GL3D_uniformIntAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), x);
+}
+
+void GL3D_uniformFloatAtLocation(int location, float x){
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+	GL3D_numberOfDriverCalls++;
 
 	glUniform1f(location, x);
 
 }
-void GL3D_uniformTexture(unsigned int shaderProgram, const char *locationName, unsigned int locationIndex, unsigned int textureID){
 
-	unsigned int location = glGetUniformLocation(shaderProgram, locationName);
+void GL3D_uniformFloat(unsigned int shaderProgram, const char *locationName, float x){
+	GL3D_uniformFloatAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), x);
+}
+
+void GL3D_uniformTextureAtLocation(int location, unsigned int locationIndex, unsigned int textureID){
+
+	GL3D_numberOfDriverCalls += 3;
+
 	glUniform1i(location, locationIndex);
 	glActiveTexture(GL_TEXTURE0 + locationIndex);
 	glBindTexture(GL_TEXTURE_2D, textureID);
 
 }
+
+void GL3D_uniformTexture(unsigned int shaderProgram, const char *locationName, unsigned int locationIndex, unsigned int textureID){
+	GL3D_uniformTextureAtLocation(GL3D_getUniformLocation(shaderProgram, locationName), locationIndex, textureID);
+}
@@ -0,0 +1,88 @@
+#include "engine/compression.h"
+
+#include "string.h"
+
+//runs are scanned 8 bytes at a time, the first byte that differs is found from the lowest set bit, which assumes a little endian machine
+void RunLength_encode(std::vector<unsigned char> *encoded_p, const unsigned char *data, int size){
+
+	size_t encodedStart = encoded_p->size();
+
+	encoded_p->resize(encodedStart + 2 * size);
+
+	unsigned char *encoded = encoded_p->data() + encodedStart;
+	int encodedSize = 0;
+
+	int i = 0;
+
+	while(i < size){
+
+		unsigned char value = data[i];
+		unsigned long long pattern = value * 0x0101010101010101ULL;
+
+		int runEnd = i + RUN_LENGTH_MAX_RUN;
+		if(runEnd > size){
+			runEnd = size;
+		}
+
+		int j = i + 1;
+
+		while(j + 8 <= runEnd){
+
+			unsigned long long word;
+			memcpy(&word, data + j, 8);
+
+			unsigned long long difference = word ^ pattern;
+
+			if(difference != 0){
+				j += __builtin_ctzll(difference) / 8;
+				break;
+			}
+
+			j += 8;
+
+		}
+
+		while(j < runEnd
+		&& data[j] == value){
+			j++;
+		}
+
+		encoded[encodedSize] = j - i - 1;
+		encoded[encodedSize + 1] = value;
+		encodedSize += 2;
+
+		i = j;
+
+	}
+
+	encoded_p->resize(encodedStart + encodedSize);
+
+}
+
+int RunLength_decode(unsigned char *data, int size, const unsigned char *encoded, int encodedSize){
+
+	int i = 0;
+	int encodedIndex = 0;
+
+	while(i < size){
+
+		if(encodedIndex + 2 > encodedSize){
+			return -1;
+		}
+
+		int runLength = encoded[encodedIndex] + 1;
+
+		if(i + runLength > size){
+			return -1;
+		}
+
+		memset(data + i, encoded[encodedIndex + 1], runLength);
+
+		i += runLength;
+		encodedIndex += 2;
+
+	}
+
+	return encodedIndex;
+
+}
@@ -1,12 +1,18 @@
 //common includes
 #include "engine/engine.h"
 #include "engine/strings.h"
+#include "engine/files.h"
+#include "engine/jobs.h"
+#include "engine/profiler.h"
+#include "engine/replay.h"
+#include "engine/3d.h"
 
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
 #include "math.h"
 #include <vector>
+#include <algorithm>
 
 //#include "glad/glad.h"
 
@@ -17,6 +23,11 @@
 
 #include "time.h"
 #include "unistd.h"
+#include "poll.h"
+
+#endif
+
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 
 #include "X11/X.h"
 #include "X11/Xlib.h"
@@ -43,7 +54,7 @@
 
 #endif
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 Display *dpy;
 int screenNumber;
 Window root;
@@ -81,6 +92,16 @@ int Engine_elapsedFrames = 0;
 
 bool Engine_fpsModeOn = false;
 
+int Engine_updatesPerSecond = 60;
+
+int Engine_framesPerSecond = 60;
+
+#ifdef ENGINE_HEADLESS
+bool Engine_isHeadless = true;
+#else
+bool Engine_isHeadless = false;
+#endif
+
 Engine_Key Engine_keys[ENGINE_KEYS_LENGTH];
 
 Engine_Pointer Engine_pointer;
@@ -88,7 +109,7 @@ Engine_Pointer Engine_pointer;
 std::vector<char> Engine_textInput;
 //Array Engine_textInput;
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 static unsigned int OS_KEY_IDENTIFIERS[] = {
 
 	XK_0,
@@ -196,6 +217,62 @@ static unsigned int OS_KEY_IDENTIFIERS[] = {
 };
 #endif
 
+#ifdef ENGINE_HEADLESS
+static unsigned int OS_KEY_IDENTIFIERS[ENGINE_KEYS_LENGTH];
+
+static const char *HEADLESS_KEY_NAMES[] = {
+
+	"0",
+	"1",
+	"2",
+	"3",
+	"4",
+	"5",
+	"6",
+	"7",
+	"8",
+	"9",
+
+	"A",
+	"B",
+	"C",
+	"D",
+	"E",
+	"F",
+	"G",
+	"H",
+	"I",
+	"J",
+	"K",
+	"L",
+	"M",
+	"N",
+	"O",
+	"P",
+	"Q",
+	"R",
+	"S",
+	"T",
+	"U",
+	"V",
+	"W",
+	"X",
+	"Y",
+	"Z",
+
+	"UP",
+	"DOWN",
+	"LEFT",
+	"RIGHT",
+
+	"SPACE",
+	"ESCAPE",
+
+	"SHIFT",
+
+};
+#endif
+
 bool programShouldQuit = false;
 
 //COMMON INITS
@@ -254,10 +331,235 @@ void resetPointer(){
 	Engine_pointer.upped = false;
 }
 
+//FIXED TIMESTEP
+
+//the headless runner calls Engine_update once per tick itself, the windowed builds run it from the frame loop on the clock
+#ifndef ENGINE_HEADLESS
+
+//after a stall at most this many updates are run to catch up, the rest of the time is dropped so the game slows down instead of falling further behind
+#define ENGINE_MAX_UPDATES_PER_FRAME 5
+
+static long long accumulatedTime = 0;
+static long long lastFrameTime = 0;
+static int numberOfFixedUpdates = 0;
+
+//runs Engine_update once for every whole update interval since the last frame and returns how far the frame is into the next update, from 0 to 1
+static float runFixedUpdates(){
+
+	long long updateTime = 1000000000LL / Engine_updatesPerSecond;
+
+	long long currentTime = Engine_getTimeNanoseconds();
+
+	if(lastFrameTime == 0){
+		lastFrameTime = currentTime - updateTime;
+	}
+
+	accumulatedTime += currentTime - lastFrameTime;
+	lastFrameTime = currentTime;
+
+	if(accumulatedTime > updateTime * ENGINE_MAX_UPDATES_PER_FRAME){
+		accumulatedTime = updateTime * ENGINE_MAX_UPDATES_PER_FRAME;
+	}
+
+	//input is only reset after an update has seen it, so presses during frames without an update are not lost
+	while(accumulatedTime >= updateTime){
+
+		InputRecorder_recordTick(numberOfFixedUpdates);
+
+		{
+			PROFILER_ZONE("update");
+
+			Engine_update(1);
+		}
+
+		resetKeys();
+		resetPointer();
+
+		numberOfFixedUpdates++;
+
+		accumulatedTime -= updateTime;
+
+	}
+
+	return (float)accumulatedTime / (float)updateTime;
+
+}
+
+#endif
+
 //ENGINE ENTRY POINT
 
-#ifdef __linux__
-int main(){
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
+
+//handles all events that have arrived, XPending also reads events that are waiting on the connection
+static void handleXEvents(){
+
+	while(XPending(dpy) > 0){
+
+		XNextEvent(dpy, &xev);
+
+		if(xev.type == ClientMessage
+		|| xev.type == DestroyNotify){
+			programShouldQuit = true;
+		}
+
+		if(xev.type == ConfigureNotify){
+
+			XConfigureEvent xce = xev.xconfigure;
+
+			if(xce.width != Engine_clientWidth
+			|| xce.height != Engine_clientHeight){
+				Engine_clientWidth = xce.width;
+				Engine_clientHeight = xce.height;
+			}
+
+		}
+
+		if(xev.type == KeyPress){
+
+			//if(xev.xkey.keycode == XKeysymToKeycode(dpy, XK_Q)){
+				//quit = true;
+			//}
+			char buffer[SMALL_STRING_SIZE];
+			String_set(buffer, "", SMALL_STRING_SIZE);
+
+			XLookupString((XKeyPressedEvent *)&xev, buffer, STRING_SIZE, NULL, NULL);
+
+			if(!(strcmp(buffer, "") == 0)){
+				Engine_textInput.push_back(*buffer);
+				//char *text = Array_addItem(&Engine_textInput);
+				//String_set(text, buffer, SMALL_STRING_SIZE);
+			}
+
+			for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
+				if(xev.xkey.keycode == XKeysymToKeycode(dpy, Engine_keys[i].OSIdentifier)){
+					if(!Engine_keys[i].down){
+						Engine_keys[i].downed = true;
+					}
+					Engine_keys[i].down = true;
+				}
+			}
+		}
+
+		if(xev.type == KeyRelease){
+
+			for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
+				if(xev.xkey.keycode == XKeysymToKeycode(dpy, Engine_keys[i].OSIdentifier)){
+					if(Engine_keys[i].down){
+						Engine_keys[i].upped = true;
+					}
+					Engine_keys[i].down = false;
+				}
+			}
+
+		}
+
+		if(xev.type == ButtonPress){
+			XButtonEvent *buttonEvent_p = (XButtonEvent *)&xev;
+
+			if(buttonEvent_p->button == 1){
+				Engine_pointer.down = true;
+				Engine_pointer.downed = true;
+				Engine_pointer.lastDownedPos = Engine_pointer.pos;
+			}
+
+		}
+		if(xev.type == ButtonRelease){
+
+			XButtonEvent *buttonEvent_p = (XButtonEvent *)&xev;
+
+			if(buttonEvent_p->button == 1){
+				Engine_pointer.down = false;
+				Engine_pointer.upped = true;
+				Engine_pointer.lastUppedPos = Engine_pointer.pos;
+			}
+
+		}
+
+		if(xev.type == MotionNotify){
+			XMotionEvent *motionEvent_p = (XMotionEvent *)&xev;
+
+			Engine_pointer.pos.x = motionEvent_p->x;
+			Engine_pointer.pos.y = motionEvent_p->y;
+
+			{
+				Engine_pointer.movement.x = motionEvent_p->x - Engine_clientWidth / 2;
+				Engine_pointer.movement.y = motionEvent_p->y - Engine_clientHeight / 2;
+			}
+		}
+	
+	}
+
+}
+
+//FRAME PACING
+
+//the last part of the wait is spun instead of slept, since a sleeping thread can be woken up later than asked
+#define FRAME_PACER_SPIN_TIME 500000
+
+static long long nextFrameTime = 0;
+
+//waits until the next frame should start on a fixed schedule, sleeping on the X connection so that input is handled as soon as it arrives
+static void waitForNextFrame(){
+
+	long long frameTime = 1000000000LL / Engine_framesPerSecond;
+
+	long long currentTime = Engine_getTimeNanoseconds();
+
+	if(nextFrameTime == 0){
+		nextFrameTime = currentTime;
+	}
+
+	nextFrameTime += frameTime;
+
+	//a frame that ran late starts the schedule over instead of making the next frames hurry to catch up
+	if(nextFrameTime < currentTime){
+		nextFrameTime = currentTime;
+		return;
+	}
+
+	struct pollfd connection;
+	connection.fd = ConnectionNumber(dpy);
+	connection.events = POLLIN;
+
+	while(true){
+
+		long long sleepTime = nextFrameTime - FRAME_PACER_SPIN_TIME - Engine_getTimeNanoseconds();
+
+		if(sleepTime <= 0){
+			break;
+		}
+
+		struct timespec timeout;
+		timeout.tv_sec = sleepTime / 1000000000LL;
+		timeout.tv_nsec = sleepTime % 1000000000LL;
+
+		if(ppoll(&connection, 1, &timeout, NULL) > 0){
+			handleXEvents();
+		}
+
+	}
+
+	while(Engine_getTimeNanoseconds() < nextFrameTime){
+	}
+
+}
+
+//usage: main [-r input-log], -r records the input of every update to the given path for the headless runner to replay
+int main(int argc, char **argv){
+
+	const char *inputLogPath = NULL;
+
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "-r") == 0
+		&& i + 1 < argc){
+			inputLogPath = argv[i + 1];
+			i++;
+		}else{
+			printf("usage: %s [-r input-log]\n", argv[0]);
+			return 1;
+		}
+	}
 
 	//setup window
 	dpy = XOpenDisplay(NULL);
@@ -344,195 +646,426 @@ int main(){
 	initKeys();
 	initPointer();
 
+	JobSystem_init(0);
+
 	Engine_start();
 
+	if(inputLogPath != NULL){
+		InputRecorder_start(inputLogPath);
+	}
+
 	//game loop
-	size_t startTicks = 0;
-	size_t endTicks = 0;
+	long long lastFrameStartTime = 0;
 
-	size_t deltaTime = 0;
-	size_t accumilatedTime = 0;
-	size_t frameTime = 1000000 / 60;
+	//bool quit = false;
 
-	int fps = 60;
+	while(!programShouldQuit){
 
-	size_t ticksPerFrame = CLOCKS_PER_SEC / fps;
+		Profiler_beginFrame();
 
-	//bool quit = false;
+		//how far apart frames start and how far that is from the target, in microseconds
+		long long frameStartTime = Engine_getTimeNanoseconds();
 
-	while(!programShouldQuit){
+		if(lastFrameStartTime != 0){
+
+			long long frameInterval = frameStartTime - lastFrameStartTime;
 
-		startTicks = clock();
+			Profiler_count("frameInterval", frameInterval / 1000);
+			Profiler_count("frameJitter", llabs(frameInterval - 1000000000LL / Engine_framesPerSecond) / 1000);
+
+		}
+
+		lastFrameStartTime = frameStartTime;
 
 		//handle events
-		while(XPending(dpy) > 0){
+		handleXEvents();
 
-			XNextEvent(dpy, &xev);
+		//do fps magic
 
-			if(xev.type == ClientMessage
-			|| xev.type == DestroyNotify){
-				programShouldQuit = true;
-			}
+		if(Engine_fpsModeOn){
 
-			if(xev.type == ConfigureNotify){
+			int screenWidth = DisplayWidth(dpy, DefaultScreen(dpy));
+			int screenHeight = DisplayHeight(dpy, DefaultScreen(dpy));
 
-				XConfigureEvent xce = xev.xconfigure;
+			XWarpPointer(dpy, None, root, 0, 0, 0, 0, screenWidth / 2, screenHeight / 2);
 
-				if(xce.width != Engine_clientWidth
-				|| xce.height != Engine_clientHeight){
-					Engine_clientWidth = xce.width;
-					Engine_clientHeight = xce.height;
-				}
+		}else{
+		}
 
-			}
+		//update
 
-			if(xev.type == KeyPress){
+		float alpha = runFixedUpdates();
 
-				//if(xev.xkey.keycode == XKeysymToKeycode(dpy, XK_Q)){
-					//quit = true;
-				//}
-				char buffer[SMALL_STRING_SIZE];
-				String_set(buffer, "", SMALL_STRING_SIZE);
+		//draw
 
-				XLookupString((XKeyPressedEvent *)&xev, buffer, STRING_SIZE, NULL, NULL);
+		{
+			PROFILER_ZONE("draw");
 
-				if(!(strcmp(buffer, "") == 0)){
-					Engine_textInput.push_back(*buffer);
-					//char *text = Array_addItem(&Engine_textInput);
-					//String_set(text, buffer, SMALL_STRING_SIZE);
-				}
+			Engine_draw(alpha);
+		}
 
-				for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
-					if(xev.xkey.keycode == XKeysymToKeycode(dpy, Engine_keys[i].OSIdentifier)){
-						if(!Engine_keys[i].down){
-							Engine_keys[i].downed = true;
-						}
-						Engine_keys[i].down = true;
-					}
-				}
-			}
+		//glDrawPixels(screenWidth, screenHeight, GL_RGB, GL_UNSIGNED_BYTE, screenPixels);
 
-			if(xev.type == KeyRelease){
+		{
+			PROFILER_ZONE("swapBuffers");
 
-				for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
-					if(xev.xkey.keycode == XKeysymToKeycode(dpy, Engine_keys[i].OSIdentifier)){
-						if(Engine_keys[i].down){
-							Engine_keys[i].upped = true;
-						}
-						Engine_keys[i].down = false;
-					}
-				}
+			glXSwapBuffers(dpy, win);
+		}
 
-			}
+		Engine_elapsedFrames++;
 
-			if(xev.type == ButtonPress){
-				XButtonEvent *buttonEvent_p = (XButtonEvent *)&xev;
+		Profiler_count("driverCalls", GL3D_numberOfDriverCalls);
+		GL3D_numberOfDriverCalls = 0;
 
-				if(buttonEvent_p->button == 1){
-					Engine_pointer.down = true;
-					Engine_pointer.downed = true;
-					Engine_pointer.lastDownedPos = Engine_pointer.pos;
-				}
+		Profiler_endFrame();
 
-			}
-			if(xev.type == ButtonRelease){
+		waitForNextFrame();
+	
+	}
+
+	InputRecorder_stop();
+
+	Engine_finnish();
+
+	JobSystem_finnish();
+
+	return 0;
+
+}
+#endif
+
+#ifdef ENGINE_HEADLESS
+/*
+Headless runner: drives Engine_start/Engine_update without a window or GL context and reports how long each tick took.
+
+usage: main-headless [-t ticks] [-s script] [-i input-log] [-r input-log] [-l snapshot] [-w snapshot] [-j threads] [-p trace] [-q]
+
+-i replays an input log recorded with -r, by the windowed build or by an earlier headless run, and runs all of its ticks unless -t is given.
+-r records the input of every tick to the given path.
+-l loads a snapshot saved with Engine_saveSnapshot after Engine_start, -w saves one after the last tick.
+-p prints per zone frame times and writes the recorded profiler zones to the given path as a Chrome trace.
+
+The state hash printed at the end comes from Engine_getStateHash, runs with the same input have to end with the same hash.
+
+Script lines are applied before the update of the given tick and must be in ascending tick order:
+	<tick> key <NAME> down|up
+	<tick> pointer <x> <y>
+	<tick> button down|up
+Empty lines and lines starting with # are ignored.
+*/
+
+enum HeadlessInputEventType{
+	HEADLESS_INPUT_EVENT_KEY,
+	HEADLESS_INPUT_EVENT_POINTER,
+	HEADLESS_INPUT_EVENT_BUTTON,
+};
+
+typedef struct HeadlessInputEvent{
+	int tick;
+	enum HeadlessInputEventType type;
+	int key;
+	bool down;
+	Vec2f pos;
+}HeadlessInputEvent;
+
+std::vector<HeadlessInputEvent> getHeadlessInputEventsFromFile(const char *path){
+
+	std::vector<HeadlessInputEvent> events;
+
+	int numberOfLines;
+	FileLine *lines = getFileLines_mustFree(path, &numberOfLines);
+
+	for(int i = 0; i < numberOfLines; i++){
+
+		char *line = lines[i];
+
+		if(line[0] == 0
+		|| line[0] == *"#"){
+			continue;
+		}
+
+		HeadlessInputEvent event;
+		char type[SMALL_STRING_SIZE];
+		char arg1[SMALL_STRING_SIZE];
+		char arg2[SMALL_STRING_SIZE];
+		char arg3[SMALL_STRING_SIZE];
+
+		int numberOfArgs = sscanf(line, "%i %31s %31s %31s %31s", &event.tick, type, arg1, arg2, arg3);
+
+		if(numberOfArgs < 3){
+			printf("Invalid input script line %i: %s\n", i + 1, line);
+			continue;
+		}
 
-				XButtonEvent *buttonEvent_p = (XButtonEvent *)&xev;
+		if(strcmp(type, "key") == 0
+		&& numberOfArgs == 4){
 
-				if(buttonEvent_p->button == 1){
-					Engine_pointer.down = false;
-					Engine_pointer.upped = true;
-					Engine_pointer.lastUppedPos = Engine_pointer.pos;
+			event.type = HEADLESS_INPUT_EVENT_KEY;
+			event.key = -1;
+			event.down = strcmp(arg2, "down") == 0;
+
+			for(int j = 0; j < ENGINE_KEYS_LENGTH; j++){
+				if(strcmp(arg1, HEADLESS_KEY_NAMES[j]) == 0){
+					event.key = j;
 				}
+			}
 
+			if(event.key == -1){
+				printf("Unknown key on input script line %i: %s\n", i + 1, arg1);
+				continue;
 			}
 
-			if(xev.type == MotionNotify){
-				XMotionEvent *motionEvent_p = (XMotionEvent *)&xev;
+		}else if(strcmp(type, "pointer") == 0
+		&& numberOfArgs == 4){
 
-				Engine_pointer.pos.x = motionEvent_p->x;
-				Engine_pointer.pos.y = motionEvent_p->y;
+			event.type = HEADLESS_INPUT_EVENT_POINTER;
+			event.pos = getVec2f(atof(arg1), atof(arg2));
 
-				{
-					Engine_pointer.movement.x = motionEvent_p->x - Engine_clientWidth / 2;
-					Engine_pointer.movement.y = motionEvent_p->y - Engine_clientHeight / 2;
-				}
+		}else if(strcmp(type, "button") == 0){
+
+			event.type = HEADLESS_INPUT_EVENT_BUTTON;
+			event.down = strcmp(arg1, "down") == 0;
+
+		}else{
+			printf("Invalid input script line %i: %s\n", i + 1, line);
+			continue;
+		}
+
+		events.push_back(event);
+
+	}
+
+	free(lines);
+
+	return events;
+
+}
+
+void applyHeadlessInputEvent(HeadlessInputEvent event){
+
+	if(event.type == HEADLESS_INPUT_EVENT_KEY){
+
+		Engine_Key *key_p = &Engine_keys[event.key];
+
+		if(event.down){
+			if(!key_p->down){
+				key_p->downed = true;
 			}
-		
+			key_p->down = true;
+		}else{
+			if(key_p->down){
+				key_p->upped = true;
+			}
+			key_p->down = false;
 		}
 
-		//do fps magic
+	}
 
-		if(Engine_fpsModeOn){
+	if(event.type == HEADLESS_INPUT_EVENT_POINTER){
 
-			int screenWidth = DisplayWidth(dpy, DefaultScreen(dpy));
-			int screenHeight = DisplayHeight(dpy, DefaultScreen(dpy));
+		Engine_pointer.pos = event.pos;
 
-			XWarpPointer(dpy, None, root, 0, 0, 0, 0, screenWidth / 2, screenHeight / 2);
+		Engine_pointer.movement.x = event.pos.x - Engine_clientWidth / 2;
+		Engine_pointer.movement.y = event.pos.y - Engine_clientHeight / 2;
 
+	}
+
+	if(event.type == HEADLESS_INPUT_EVENT_BUTTON){
+
+		if(event.down){
+			Engine_pointer.down = true;
+			Engine_pointer.downed = true;
+			Engine_pointer.lastDownedPos = Engine_pointer.pos;
 		}else{
+			Engine_pointer.down = false;
+			Engine_pointer.upped = true;
+			Engine_pointer.lastUppedPos = Engine_pointer.pos;
 		}
 
-		//update
+	}
 
-		//while(accumilatedTime > frameTime){
+}
 
-		Engine_update(1);
+int main(int argc, char **argv){
+
+	int numberOfTicks = -1;
+	int numberOfThreads = 0;
+	const char *scriptPath = NULL;
+	const char *replayPath = NULL;
+	const char *recordPath = NULL;
+	const char *loadSnapshotPath = NULL;
+	const char *saveSnapshotPath = NULL;
+	const char *tracePath = NULL;
+	bool printEveryTick = true;
+
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "-t") == 0
+		&& i + 1 < argc){
+			numberOfTicks = atoi(argv[i + 1]);
+			i++;
+		}else if(strcmp(argv[i], "-s") == 0
+		&& i + 1 < argc){
+			scriptPath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-i") == 0
+		&& i + 1 < argc){
+			replayPath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-r") == 0
+		&& i + 1 < argc){
+			recordPath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-l") == 0
+		&& i + 1 < argc){
+			loadSnapshotPath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-w") == 0
+		&& i + 1 < argc){
+			saveSnapshotPath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-j") == 0
+		&& i + 1 < argc){
+			numberOfThreads = atoi(argv[i + 1]);
+			i++;
+		}else if(strcmp(argv[i], "-p") == 0
+		&& i + 1 < argc){
+			tracePath = argv[i + 1];
+			i++;
+		}else if(strcmp(argv[i], "-q") == 0){
+			printEveryTick = false;
+		}else{
+			printf("usage: %s [-t ticks] [-s script] [-i input-log] [-r input-log] [-l snapshot] [-w snapshot] [-j threads] [-p trace] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
 
-			//accumilatedTime -= frameTime;
+	std::vector<HeadlessInputEvent> events;
 
-		resetKeys();
-		resetPointer();
-			
-		//}
+	if(scriptPath != NULL){
+		events = getHeadlessInputEventsFromFile(scriptPath);
+	}
 
-		//draw
+	if(replayPath != NULL){
 
-		Engine_draw();
+		if(!InputReplay_load(replayPath)){
+			return 1;
+		}
 
-		//glDrawPixels(screenWidth, screenHeight, GL_RGB, GL_UNSIGNED_BYTE, screenPixels);
+		if(numberOfTicks < 0){
+			numberOfTicks = InputReplay_getNumberOfTicks();
+		}
 
-		glXSwapBuffers(dpy, win);
+	}
 
-		Engine_elapsedFrames++;
+	if(numberOfTicks < 0){
+		numberOfTicks = 600;
+	}
 
-		endTicks = clock();
+	initKeys();
+	initPointer();
 
-		deltaTime = (endTicks - startTicks) / (CLOCKS_PER_SEC / 1000000);
+	JobSystem_init(numberOfThreads);
 
-		//printf("\nframeTime: %i\n", deltaTime);
+	Engine_start();
 
-		//printf("%f\n", (float)deltaTime / 1000);
+	if(loadSnapshotPath != NULL
+	&& !Engine_loadSnapshot(loadSnapshotPath)){
+		return 1;
+	}
 
-		int lag = frameTime - deltaTime;
+	if(recordPath != NULL
+	&& !InputRecorder_start(recordPath)){
+		return 1;
+	}
+
+	std::vector<double> tickTimes;
+	int currentEvent = 0;
+
+	double startTime = Engine_getTimeNanoseconds() / 1000000.0;
 
-		//printf("lag: %i\n", lag);
+	for(int tick = 0; tick < numberOfTicks && !programShouldQuit; tick++){
 
-		if(lag < 0){
-			lag = 0;
+		while(currentEvent < events.size()
+		&& events[currentEvent].tick <= tick){
+			applyHeadlessInputEvent(events[currentEvent]);
+			currentEvent++;
 		}
 
-		usleep(lag);
+		if(replayPath != NULL){
+			InputReplay_applyTick(tick);
+		}
 
-		//accumilatedTime += deltaTime;
+		InputRecorder_recordTick(tick);
 
-		//printf("%i\n", deltaTime);
+		Profiler_beginFrame();
 
-		//int lag = ticksPerFrame - (endTicks - startTicks);
+		double tickStartTime = Engine_getTimeNanoseconds() / 1000000.0;
 
-		//if(lag < 0){
-			//lag = 0;
-		//}
+		{
+			PROFILER_ZONE("update");
 
-		//float lagMilliseconds = (float)lag / (float)(CLOCKS_PER_SEC / 1000);
+			Engine_update(1);
+		}
 
-		//usleep(lagMilliseconds * 1000);
+		double tickTime = Engine_getTimeNanoseconds() / 1000000.0 - tickStartTime;
+
+		Profiler_endFrame();
+
+		tickTimes.push_back(tickTime);
+
+		if(printEveryTick){
+			printf("tick %i: %f ms\n", tick, tickTime);
+		}
+
+		resetKeys();
+		resetPointer();
+
+		Engine_elapsedFrames++;
 
-	
 	}
 
+	double totalTime = Engine_getTimeNanoseconds() / 1000000.0 - startTime;
+
+	InputRecorder_stop();
+
+	if(saveSnapshotPath != NULL){
+		Engine_saveSnapshot(saveSnapshotPath);
+	}
+
+	unsigned long long stateHash = Engine_getStateHash();
+
 	Engine_finnish();
 
+	JobSystem_finnish();
+
+	//with -p the zone report is printed and all recorded zones are written as a Chrome trace
+	if(tracePath != NULL){
+		Profiler_printReport();
+		Profiler_writeChromeTrace(tracePath);
+	}
+
+	printf("state hash: %016llx\n", stateHash);
+
+	if(tickTimes.size() == 0){
+		return 0;
+	}
+
+	std::vector<double> sortedTickTimes = tickTimes;
+	std::sort(sortedTickTimes.begin(), sortedTickTimes.end());
+
+	double tickTimeSum = 0;
+	for(int i = 0; i < tickTimes.size(); i++){
+		tickTimeSum += tickTimes[i];
+	}
+
+	printf("ticks: %i\n", (int)tickTimes.size());
+	printf("total: %f ms\n", totalTime);
+	printf("min: %f ms\n", sortedTickTimes.front());
+	printf("avg: %f ms\n", tickTimeSum / tickTimes.size());
+	printf("p99: %f ms\n", sortedTickTimes[(sortedTickTimes.size() - 1) * 99 / 100]);
+	printf("max: %f ms\n", sortedTickTimes.back());
+	printf("ticks per second: %f\n", tickTimes.size() / (totalTime / 1000.0));
+
 	return 0;
 
 }
@@ -617,25 +1150,17 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	//initPixelDrawing();
 	initKeys();
 	initPointer();
+
+	JobSystem_init(0);
 	
 	Engine_start();
 	
 	ShowWindow(hwnd, nCmdShow);
 
-	LARGE_INTEGER liFrequency = {0};
-	LARGE_INTEGER liStart = {0};
-	LARGE_INTEGER liStop = {0};
-
-	float deltaTime;
-
-	float accumilatedTime = 0;
-
 	//game loop
 	while(!programShouldQuit){
 
-		QueryPerformanceFrequency(&liFrequency);
-
-		QueryPerformanceCounter(&liStart);
+		Profiler_beginFrame();
 	
 		//handle events
 		MSG msg = {};
@@ -647,41 +1172,37 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		}
 
 		//update
-			
-		while(accumilatedTime > 1000 / 60){
-
-			Engine_update((float)(1 / 60));
-
-			accumilatedTime -= 1000 / 60;
 
-			resetKeys();
-			resetPointer();
-
-			//printf("hello from here %f\n", accumilatedTime);
-		
-		}
+		float alpha = runFixedUpdates();
 		
 		//draw
 		
-		Engine_draw();
+		{
+			PROFILER_ZONE("draw");
+
+			Engine_draw(alpha);
+		}
 		
-		SwapBuffers(hdc);
+		{
+			PROFILER_ZONE("swapBuffers");
+
+			SwapBuffers(hdc);
+		}
 		
 		//glDrawPixels(screenWidth, screenHeight, GL_RGB, GL_UNSIGNED_BYTE, screenPixels);
 
 		Engine_elapsedFrames++;
 
-		QueryPerformanceCounter(&liStop);
-
-		deltaTime = (float)((liStop.QuadPart - liStart.QuadPart) * 1000000 / liFrequency.QuadPart) / 1000;
+		Profiler_count("driverCalls", GL3D_numberOfDriverCalls);
+		GL3D_numberOfDriverCalls = 0;
 
-		accumilatedTime += deltaTime;
-		
-		//printf("%f\n", deltaTime);
+		Profiler_endFrame();
 
 	}
 
 	Engine_finnish();
+
+	JobSystem_finnish();
 	
 	return 0;
 	
@@ -761,7 +1282,7 @@ void Engine_setFPSMode(bool setting){
 
 	Engine_fpsModeOn = setting;
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 	if(Engine_fpsModeOn){
 		XFixesHideCursor(dpy, root);
 		XFlush(dpy);
@@ -794,7 +1315,7 @@ void Engine_setWindowSize(int width, int height){
 	Engine_clientWidth = width;
 	Engine_clientHeight = height;
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 	XResizeWindow(dpy, win, width, height);
 #endif
 
@@ -818,7 +1339,7 @@ void Engine_setWindowSize(int width, int height){
 
 void Engine_centerWindow(){
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 	XMoveWindow(dpy, win, DisplayWidth(dpy, screenNumber) / 2 - Engine_clientWidth / 2, DisplayHeight(dpy, screenNumber) / 2 - Engine_clientHeight / 2);
 #endif
 
@@ -841,7 +1362,7 @@ void Engine_toggleFullscreen(){
 	}
 #endif
 
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 	if(!Engine_isFullscreen){
 
 		Engine_setWindowSize(DisplayWidth(dpy, screenNumber), DisplayHeight(dpy, screenNumber));
@@ -861,7 +1382,7 @@ void Engine_toggleFullscreen(){
 
 void Engine_setPointerPosition(int x, int y){
 	
-#ifdef __linux__
+#if defined(__linux__) && !defined(ENGINE_HEADLESS)
 	XWarpPointer(dpy, None, win, 0, 0, 0, 0, x, y);
 #endif
 
@@ -4,27 +4,157 @@
 #include "stdlib.h"
 #include "string.h"
 
-char *getFileData_mustFree(const char *path, long int *fileSizeOut){
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "fcntl.h"
+#include "unistd.h"
+#endif
+
+#define FILE_WRITER_BUFFER_SIZE (1 << 20)
+
+static void printCouldNotLoadFile(const char *path){
+	printf("!!********************!!\n");
+	printf("Could not load file: %s\n", path);
+	printf("!!********************!!\n");
+}
+
+//FILE VIEW FUNCTIONS
+
+bool FileView_init(FileView *fileView_p, const char *path){
+
+	fileView_p->data = NULL;
+	fileView_p->size = 0;
+	fileView_p->mapped = false;
+
+#ifdef _WIN32
+
+	HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if(fileHandle == INVALID_HANDLE_VALUE){
+		printCouldNotLoadFile(path);
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+
+	fileView_p->size = fileSize.QuadPart;
+
+	if(fileView_p->size > 0){
+
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if(mappingHandle != NULL){
+			fileView_p->data = (const char *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mappingHandle);
+		}
+
+	}
+
+	CloseHandle(fileHandle);
+
+#else
+
+	int fileDescriptor = open(path, O_RDONLY);
+
+	if(fileDescriptor == -1){
+		printCouldNotLoadFile(path);
+		return false;
+	}
+
+	struct stat fileStat;
+	fstat(fileDescriptor, &fileStat);
 
-	char *data = NULL;
+	fileView_p->size = fileStat.st_size;
+
+	if(fileView_p->size > 0){
+
+		void *data = mmap(NULL, fileView_p->size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+		if(data != MAP_FAILED){
+			fileView_p->data = (const char *)data;
+		}
+
+	}
+
+	close(fileDescriptor);
+
+#endif
+
+	if(fileView_p->data != NULL){
+		fileView_p->mapped = true;
+		return true;
+	}
+
+	//empty files can not be mapped, and some file systems do not support it, so those are read instead
+	long int fileSize;
+	char *data = getFileData_mustFree(path, &fileSize);
+
+	if(data == NULL){
+		return false;
+	}
+
+	fileView_p->data = data;
+	fileView_p->size = fileSize;
+
+	return true;
+
+}
+
+void FileView_release(FileView *fileView_p){
+
+	if(fileView_p->data == NULL){
+		return;
+	}
+
+	if(fileView_p->mapped){
+#ifdef _WIN32
+		UnmapViewOfFile(fileView_p->data);
+#else
+		munmap((void *)fileView_p->data, fileView_p->size);
+#endif
+	}else{
+		free((void *)fileView_p->data);
+	}
+
+	fileView_p->data = NULL;
+	fileView_p->size = 0;
+
+}
 
-	FILE *fileHandle = NULL;
+//READ FUNCTIONS
 
-	fileHandle = fopen(path, "r");
-  
-    fseek(fileHandle, 0L, SEEK_END);
-    long int fileSize = ftell(fileHandle);
-    fseek(fileHandle, 0L, 0);
+//reads the whole file with one fread, the data is followed by a zero so that text files can be used as strings, returns NULL if the file can not be read
+char *getFileData_mustFree(const char *path, long int *fileSizeOut){
 
-	data = (char *)malloc(sizeof(char) * fileSize + 1);
-	memset(data, 0, sizeof(char) * fileSize + 1);
+	FILE *fileHandle = fopen(path, "rb");
 
-	for(int i = 0; i < fileSize; i++){
-		data[i] = fgetc(fileHandle);
+	if(fileHandle == NULL){
+		printCouldNotLoadFile(path);
+		return NULL;
 	}
 
+	fseek(fileHandle, 0L, SEEK_END);
+	long int fileSize = ftell(fileHandle);
+	fseek(fileHandle, 0L, SEEK_SET);
+
+	char *data = (char *)malloc(fileSize + 1);
+
+	long int readSize = fread(data, 1, fileSize, fileHandle);
+
 	fclose(fileHandle);
 
+	if(readSize != fileSize){
+		printCouldNotLoadFile(path);
+		free(data);
+		return NULL;
+	}
+
+	data[fileSize] = 0;
+
 	*fileSizeOut = fileSize;
 
 	return data;
@@ -33,9 +163,15 @@ char *getFileData_mustFree(const char *path, long int *fileSizeOut){
 
 FileLine *getFileLines_mustFree(const char *path, int *numberOfLines_out){
 
-	long int dataSize;
+	FileView fileView;
 
-	char *data = getFileData_mustFree(path, &dataSize);
+	if(!FileView_init(&fileView, path)){
+		*numberOfLines_out = 0;
+		return NULL;
+	}
+
+	const char *data = fileView.data;
+	long int dataSize = fileView.size;
 	
 	int numberOfLines = 1;
 	for(int i = 0; i < dataSize; i++){
@@ -63,7 +199,7 @@ FileLine *getFileLines_mustFree(const char *path, int *numberOfLines_out){
 
 	}
 
-	free(data);
+	FileView_release(&fileView);
 
 	*numberOfLines_out = numberOfLines;
 
@@ -71,18 +207,104 @@ FileLine *getFileLines_mustFree(const char *path, int *numberOfLines_out){
 
 }
 
-void writeDataToFile(const char *path, char *data_p, long int fileSize){
+//WRITE FUNCTIONS
+
+bool FileWriter_init(FileWriter *fileWriter_p, const char *path){
 
-	FILE *fileHandle = NULL;
+	String_set(fileWriter_p->path, path, STRING_SIZE);
+	snprintf(fileWriter_p->temporaryPath, STRING_SIZE, "%s.tmp", path);
 
-	fileHandle = fopen(path, "w");
+	fileWriter_p->failed = false;
+	fileWriter_p->buffer = NULL;
 
-	for(int i = 0; i < fileSize; i++){
-		fputc(data_p[i], fileHandle);
+	fileWriter_p->file_p = fopen(fileWriter_p->temporaryPath, "wb");
+
+	if(fileWriter_p->file_p == NULL){
+		printf("Could not open file for writing: %s\n", fileWriter_p->temporaryPath);
+		fileWriter_p->failed = true;
+		return false;
 	}
 
-	fputc(EOF, fileHandle);
-	
-	fclose(fileHandle);
+	fileWriter_p->buffer = (char *)malloc(FILE_WRITER_BUFFER_SIZE);
+
+	setvbuf(fileWriter_p->file_p, fileWriter_p->buffer, _IOFBF, FILE_WRITER_BUFFER_SIZE);
+
+	return true;
+
+}
+
+void FileWriter_write(FileWriter *fileWriter_p, const void *data, long int size){
+
+	if(fileWriter_p->failed){
+		return;
+	}
+
+	if(fwrite(data, 1, size, fileWriter_p->file_p) != size){
+		fileWriter_p->failed = true;
+	}
+
+}
+
+//closes the temporary file and moves it over the file at path, returns false and leaves the old file in place if any write failed
+bool FileWriter_finish(FileWriter *fileWriter_p){
+
+	if(fileWriter_p->file_p == NULL){
+		return false;
+	}
+
+	if(fflush(fileWriter_p->file_p) != 0){
+		fileWriter_p->failed = true;
+	}
+
+#ifndef _WIN32
+	//the data has to be on disk before the rename, otherwise a crash could leave an empty file at path
+	if(!fileWriter_p->failed
+	&& fsync(fileno(fileWriter_p->file_p)) != 0){
+		fileWriter_p->failed = true;
+	}
+#endif
+
+	if(fclose(fileWriter_p->file_p) != 0){
+		fileWriter_p->failed = true;
+	}
+
+	fileWriter_p->file_p = NULL;
+
+	free(fileWriter_p->buffer);
+	fileWriter_p->buffer = NULL;
+
+	if(!fileWriter_p->failed){
+#ifdef _WIN32
+		if(!MoveFileExA(fileWriter_p->temporaryPath, fileWriter_p->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)){
+			fileWriter_p->failed = true;
+		}
+#else
+		if(rename(fileWriter_p->temporaryPath, fileWriter_p->path) != 0){
+			fileWriter_p->failed = true;
+		}
+#endif
+	}
+
+	if(fileWriter_p->failed){
+		printf("Could not write file: %s\n", fileWriter_p->path);
+		remove(fileWriter_p->temporaryPath);
+		return false;
+	}
+
+	return true;
+
+}
+
+bool writeDataToFile(const char *path, const char *data_p, long int fileSize){
+
+	FileWriter fileWriter;
+
+	if(!FileWriter_init(&fileWriter, path)){
+		return false;
+	}
+
+	FileWriter_write(&fileWriter, data_p, fileSize);
+
+	return FileWriter_finish(&fileWriter);
 
 }
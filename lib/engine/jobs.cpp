@@ -0,0 +1,193 @@
+#include "engine/jobs.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/*
+Small work-stealing job system. JobSystem_parallelFor splits a range into batches and deals them out to one queue per thread.
+Every thread takes work from the back of its own queue and steals from the front of the others when it runs dry.
+The calling thread works as thread 0 until all batches are done, so there is one worker thread less than the thread count.
+Only one parallelFor may run at a time, and only from the thread that called JobSystem_init.
+*/
+
+typedef struct Job{
+	JobFunction function;
+	void *data;
+	int start;
+	int end;
+}Job;
+
+typedef struct JobQueue{
+	std::mutex mutex;
+	std::deque<Job> jobs;
+}JobQueue;
+
+static int numberOfThreads = 1;
+static std::vector<std::thread> workers;
+static JobQueue *queues = NULL;
+
+static std::atomic<int> remainingJobs(0);
+
+static std::mutex wakeMutex;
+static std::condition_variable wakeCondition;
+static int generation = 0;
+static bool shouldQuit = false;
+
+static bool popJob(int threadIndex, Job *job_p){
+
+	{
+		JobQueue *queue_p = &queues[threadIndex];
+		std::lock_guard<std::mutex> lock(queue_p->mutex);
+
+		if(queue_p->jobs.size() > 0){
+			*job_p = queue_p->jobs.back();
+			queue_p->jobs.pop_back();
+			return true;
+		}
+	}
+
+	for(int i = 1; i < numberOfThreads; i++){
+
+		JobQueue *queue_p = &queues[(threadIndex + i) % numberOfThreads];
+		std::lock_guard<std::mutex> lock(queue_p->mutex);
+
+		if(queue_p->jobs.size() > 0){
+			*job_p = queue_p->jobs.front();
+			queue_p->jobs.pop_front();
+			return true;
+		}
+
+	}
+
+	return false;
+
+}
+
+static void runWorker(int threadIndex){
+
+	while(true){
+
+		int seenGeneration;
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+
+			if(shouldQuit){
+				return;
+			}
+
+			seenGeneration = generation;
+		}
+
+		Job job;
+		while(popJob(threadIndex, &job)){
+			job.function(job.data, job.start, job.end, threadIndex);
+			remainingJobs--;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCondition.wait(lock, [seenGeneration]{ return generation != seenGeneration || shouldQuit; });
+
+	}
+
+}
+
+//0 threads uses one thread per hardware thread
+void JobSystem_init(int threads){
+
+	if(threads <= 0){
+		threads = std::thread::hardware_concurrency();
+	}
+	if(threads <= 0){
+		threads = 1;
+	}
+
+	numberOfThreads = threads;
+	queues = new JobQueue[numberOfThreads];
+
+	for(int i = 1; i < numberOfThreads; i++){
+		workers.push_back(std::thread(runWorker, i));
+	}
+
+}
+
+void JobSystem_finnish(){
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		shouldQuit = true;
+	}
+	wakeCondition.notify_all();
+
+	for(int i = 0; i < workers.size(); i++){
+		workers[i].join();
+	}
+	workers.clear();
+
+	delete[] queues;
+	queues = NULL;
+
+	numberOfThreads = 1;
+	shouldQuit = false;
+
+}
+
+int JobSystem_getNumberOfThreads(){
+	return numberOfThreads;
+}
+
+//calls function on batches of at most batchSize items of [0, length) and returns when all of them are done
+void JobSystem_parallelFor(int length, int batchSize, JobFunction function, void *data){
+
+	if(length <= 0){
+		return;
+	}
+
+	if(queues == NULL
+	|| numberOfThreads == 1
+	|| length <= batchSize){
+		function(data, 0, length, 0);
+		return;
+	}
+
+	int numberOfJobs = (length + batchSize - 1) / batchSize;
+
+	remainingJobs += numberOfJobs;
+
+	for(int i = 0; i < numberOfJobs; i++){
+
+		Job job;
+		job.function = function;
+		job.data = data;
+		job.start = i * batchSize;
+		job.end = job.start + batchSize < length ? job.start + batchSize : length;
+
+		//consecutive batches go to the same queue so that neighbouring work tends to stay on one thread
+		JobQueue *queue_p = &queues[(long)i * numberOfThreads / numberOfJobs];
+		std::lock_guard<std::mutex> lock(queue_p->mutex);
+		queue_p->jobs.push_front(job);
+
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		generation++;
+	}
+	wakeCondition.notify_all();
+
+	Job job;
+	while(remainingJobs > 0){
+		if(popJob(0, &job)){
+			job.function(job.data, job.start, job.end, 0);
+			remainingJobs--;
+		}else{
+			std::this_thread::yield();
+		}
+	}
+
+}
@@ -0,0 +1,699 @@
+#include "engine/mesh.h"
+#include "engine/files.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+static unsigned int getVertexHash(const float *vertex){
+
+	unsigned int hash = 2166136261u;
+
+	for(int i = 0; i < MESH_VERTEX_FLOATS; i++){
+
+		//0.0 and -0.0 are equal vertices, so they have to hash the same
+		float value = vertex[i] == 0.0 ? 0.0 : vertex[i];
+
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(unsigned int));
+
+		hash = (hash ^ bits) * 16777619u;
+
+	}
+
+	return hash;
+
+}
+
+static bool getVerticesAreEqual(const float *vertex1, const float *vertex2){
+
+	for(int i = 0; i < MESH_VERTEX_FLOATS; i++){
+		if(vertex1[i] != vertex2[i]){
+			return false;
+		}
+	}
+
+	return true;
+
+}
+
+//welds the vertices of a .mesh triangle list that have exactly the same attributes, keeping the order they first appear in
+void IndexedMesh_initFromMeshData(IndexedMesh *indexedMesh_p, const unsigned char *mesh, int numberOfTriangles){
+
+	const float *meshFloats = (const float *)mesh;
+	int numberOfMeshVertices = numberOfTriangles * 3;
+
+	indexedMesh_p->vertices.clear();
+	indexedMesh_p->indices.resize(numberOfMeshVertices);
+
+	//open addressing table from vertex hash to vertex index, kept at most half full
+	int tableSize = 1;
+	while(tableSize < numberOfMeshVertices * 2){
+		tableSize *= 2;
+	}
+
+	std::vector<int> table(tableSize, -1);
+
+	int numberOfVertices = 0;
+
+	for(int i = 0; i < numberOfMeshVertices; i++){
+
+		const float *vertex = meshFloats + i * MESH_VERTEX_FLOATS;
+
+		int slot = getVertexHash(vertex) & (tableSize - 1);
+
+		while(table[slot] != -1
+		&& !getVerticesAreEqual(&indexedMesh_p->vertices[table[slot] * MESH_VERTEX_FLOATS], vertex)){
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if(table[slot] == -1){
+
+			table[slot] = numberOfVertices;
+
+			indexedMesh_p->vertices.insert(indexedMesh_p->vertices.end(), vertex, vertex + MESH_VERTEX_FLOATS);
+
+			numberOfVertices++;
+
+		}
+
+		indexedMesh_p->indices[i] = table[slot];
+
+	}
+
+}
+
+int IndexedMesh_getNumberOfVertices(IndexedMesh *indexedMesh_p){
+	return indexedMesh_p->vertices.size() / MESH_VERTEX_FLOATS;
+}
+
+//16 bit indices are used whenever all vertices can be reached with them
+int IndexedMesh_getIndexSize(IndexedMesh *indexedMesh_p){
+
+	if(IndexedMesh_getNumberOfVertices(indexedMesh_p) <= 65536){
+		return sizeof(unsigned short);
+	}
+
+	return sizeof(unsigned int);
+
+}
+
+//COMPACT VERTEX FUNCTIONS
+
+static unsigned short getUnorm16(float value){
+
+	if(value < 0.0){
+		value = 0.0;
+	}
+	if(value > 1.0){
+		value = 1.0;
+	}
+
+	return (unsigned short)roundf(value * 65535.0);
+
+}
+
+static int getSnorm10(float value){
+
+	if(value < -1.0){
+		value = -1.0;
+	}
+	if(value > 1.0){
+		value = 1.0;
+	}
+
+	return (int)roundf(value * 511.0) & 0x3ff;
+
+}
+
+static float getFloatFromSnorm10(unsigned int bits){
+
+	int value = bits & 0x3ff;
+
+	if(value >= 512){
+		value -= 1024;
+	}
+
+	return fmax(value / 511.0, -1.0);
+
+}
+
+static void getMeshBounds(IndexedMesh *indexedMesh_p, float *boundsMin, float *boundsSize){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+
+	for(int j = 0; j < 3; j++){
+
+		float min = numberOfVertices > 0 ? indexedMesh_p->vertices[j] : 0.0;
+		float max = min;
+
+		for(int i = 0; i < numberOfVertices; i++){
+			float value = indexedMesh_p->vertices[i * MESH_VERTEX_FLOATS + j];
+			min = fmin(min, value);
+			max = fmax(max, value);
+		}
+
+		boundsMin[j] = min;
+		boundsSize[j] = max - min;
+
+	}
+
+}
+
+//compact texture coordinates are within 0 to 1, so meshes with tiled or negative texture coordinates have to keep float vertices
+bool IndexedMesh_canUseCompactVertices(IndexedMesh *indexedMesh_p){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+
+	for(int i = 0; i < numberOfVertices; i++){
+		for(int j = 3; j < 5; j++){
+
+			float value = indexedMesh_p->vertices[i * MESH_VERTEX_FLOATS + j];
+
+			if(!(value >= 0.0 && value <= 1.0)){
+				return false;
+			}
+
+		}
+	}
+
+	return true;
+
+}
+
+//the bounds are written to boundsMin and boundsSize, positions are decoded as boundsMin + position / 65535 * boundsSize
+void IndexedMesh_getCompactVertices(IndexedMesh *indexedMesh_p, std::vector<CompactMeshVertex> *compactVertices_p, float *boundsMin, float *boundsSize){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+
+	getMeshBounds(indexedMesh_p, boundsMin, boundsSize);
+
+	compactVertices_p->resize(numberOfVertices);
+
+	for(int i = 0; i < numberOfVertices; i++){
+
+		const float *vertex = &indexedMesh_p->vertices[i * MESH_VERTEX_FLOATS];
+		CompactMeshVertex *compactVertex_p = &(*compactVertices_p)[i];
+
+		for(int j = 0; j < 3; j++){
+			compactVertex_p->position[j] = boundsSize[j] > 0.0 ? getUnorm16((vertex[j] - boundsMin[j]) / boundsSize[j]) : 0;
+		}
+		compactVertex_p->position[3] = 0;
+
+		compactVertex_p->textureCoord[0] = getUnorm16(vertex[3]);
+		compactVertex_p->textureCoord[1] = getUnorm16(vertex[4]);
+
+		compactVertex_p->normal = getSnorm10(vertex[5]) | (getSnorm10(vertex[6]) << 10) | (getSnorm10(vertex[7]) << 20);
+
+	}
+
+}
+
+MeshQuantizationError IndexedMesh_getQuantizationError(IndexedMesh *indexedMesh_p){
+
+	std::vector<CompactMeshVertex> compactVertices;
+	float boundsMin[3];
+	float boundsSize[3];
+
+	IndexedMesh_getCompactVertices(indexedMesh_p, &compactVertices, boundsMin, boundsSize);
+
+	float largestSize = fmax(boundsSize[0], fmax(boundsSize[1], boundsSize[2]));
+
+	MeshQuantizationError error;
+	error.position = 0.0;
+	error.textureCoord = 0.0;
+	error.normalDegrees = 0.0;
+
+	for(int i = 0; i < compactVertices.size(); i++){
+
+		const float *vertex = &indexedMesh_p->vertices[i * MESH_VERTEX_FLOATS];
+		CompactMeshVertex *compactVertex_p = &compactVertices[i];
+
+		for(int j = 0; j < 3; j++){
+			float position = boundsMin[j] + compactVertex_p->position[j] / 65535.0 * boundsSize[j];
+			error.position = fmax(error.position, fabs(position - vertex[j]) / largestSize);
+		}
+
+		for(int j = 0; j < 2; j++){
+			error.textureCoord = fmax(error.textureCoord, fabs(compactVertex_p->textureCoord[j] / 65535.0 - vertex[3 + j]));
+		}
+
+		float normal[3];
+		normal[0] = getFloatFromSnorm10(compactVertex_p->normal);
+		normal[1] = getFloatFromSnorm10(compactVertex_p->normal >> 10);
+		normal[2] = getFloatFromSnorm10(compactVertex_p->normal >> 20);
+
+		float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float vertexNormalLength = sqrtf(vertex[5] * vertex[5] + vertex[6] * vertex[6] + vertex[7] * vertex[7]);
+
+		if(normalLength > 0.0
+		&& vertexNormalLength > 0.0){
+
+			float cosine = (normal[0] * vertex[5] + normal[1] * vertex[6] + normal[2] * vertex[7]) / (normalLength * vertexNormalLength);
+
+			error.normalDegrees = fmax(error.normalDegrees, acosf(fmin(cosine, 1.0)) * 180.0 / M_PI);
+
+		}
+
+	}
+
+	return error;
+
+}
+
+bool IndexedMesh_writeToFile(IndexedMesh *indexedMesh_p, const char *path, enum MeshVertexFormat vertexFormat){
+
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT
+	&& !IndexedMesh_canUseCompactVertices(indexedMesh_p)){
+		printf("Indexed mesh has texture coordinates outside of 0 to 1 and can not have compact vertices: %s\n", path);
+		return false;
+	}
+
+	IndexedMeshHeader header;
+	memset(&header, 0, sizeof(IndexedMeshHeader));
+	memcpy(header.magic, INDEXED_MESH_MAGIC, 4);
+	header.version = INDEXED_MESH_VERSION;
+	header.numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+	header.numberOfIndices = indexedMesh_p->indices.size();
+	header.indexSize = IndexedMesh_getIndexSize(indexedMesh_p);
+	header.vertexFormat = vertexFormat;
+
+	std::vector<CompactMeshVertex> compactVertices;
+
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+		IndexedMesh_getCompactVertices(indexedMesh_p, &compactVertices, header.boundsMin, header.boundsSize);
+	}
+
+	FileWriter fileWriter;
+
+	if(!FileWriter_init(&fileWriter, path)){
+		return false;
+	}
+
+	FileWriter_write(&fileWriter, &header, sizeof(IndexedMeshHeader));
+
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+		FileWriter_write(&fileWriter, compactVertices.data(), compactVertices.size() * sizeof(CompactMeshVertex));
+	}else{
+		FileWriter_write(&fileWriter, indexedMesh_p->vertices.data(), indexedMesh_p->vertices.size() * sizeof(float));
+	}
+
+	if(header.indexSize == sizeof(unsigned short)){
+
+		std::vector<unsigned short> shortIndices(indexedMesh_p->indices.begin(), indexedMesh_p->indices.end());
+
+		FileWriter_write(&fileWriter, shortIndices.data(), shortIndices.size() * sizeof(unsigned short));
+
+	}else{
+		FileWriter_write(&fileWriter, indexedMesh_p->indices.data(), indexedMesh_p->indices.size() * sizeof(unsigned int));
+	}
+
+	return FileWriter_finish(&fileWriter);
+
+}
+
+//VERTEX CACHE FUNCTIONS
+
+//the triangle order is optimized for an LRU cache of this size, which also works well for smaller FIFO caches
+#define VERTEX_CACHE_SIZE 32
+
+#define VERTEX_CACHE_DECAY_POWER 1.5
+#define VERTEX_LAST_TRIANGLE_SCORE 0.75
+#define VERTEX_VALENCE_BOOST_SCALE 2.0
+#define VERTEX_VALENCE_BOOST_POWER 0.5
+
+typedef struct CacheVertex{
+	int cachePosition;
+	int numberOfRemainingTriangles;
+	int firstTriangle;
+	int numberOfTriangles;
+	float score;
+}CacheVertex;
+
+static float getVertexScore(CacheVertex *vertex_p){
+
+	if(vertex_p->numberOfRemainingTriangles == 0){
+		return -1.0;
+	}
+
+	float score = 0.0;
+
+	if(vertex_p->cachePosition >= 0){
+		//the vertices of the last triangle get a fixed score so that the next triangle does not just reuse all three
+		if(vertex_p->cachePosition < 3){
+			score = VERTEX_LAST_TRIANGLE_SCORE;
+		}else{
+			score = powf(1.0 - (float)(vertex_p->cachePosition - 3) / (float)(VERTEX_CACHE_SIZE - 3), VERTEX_CACHE_DECAY_POWER);
+		}
+	}
+
+	//vertices with few triangles left are boosted so that they are finished off instead of being left for later
+	score += VERTEX_VALENCE_BOOST_SCALE * powf((float)vertex_p->numberOfRemainingTriangles, -VERTEX_VALENCE_BOOST_POWER);
+
+	return score;
+
+}
+
+//reorders the triangles with Tom Forsyth's linear speed vertex cache optimization so that vertices are reused while still in the post transform cache
+void IndexedMesh_optimizeVertexCache(IndexedMesh *indexedMesh_p){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+	int numberOfTriangles = indexedMesh_p->indices.size() / 3;
+
+	std::vector<unsigned int> *indices_p = &indexedMesh_p->indices;
+
+	std::vector<CacheVertex> vertices(numberOfVertices);
+
+	for(int i = 0; i < numberOfVertices; i++){
+		vertices[i].cachePosition = -1;
+		vertices[i].numberOfRemainingTriangles = 0;
+		vertices[i].numberOfTriangles = 0;
+	}
+
+	for(int i = 0; i < numberOfTriangles * 3; i++){
+		vertices[(*indices_p)[i]].numberOfRemainingTriangles++;
+	}
+
+	//the triangles of every vertex are stored after each other in one array
+	int firstTriangle = 0;
+	for(int i = 0; i < numberOfVertices; i++){
+		vertices[i].firstTriangle = firstTriangle;
+		firstTriangle += vertices[i].numberOfRemainingTriangles;
+		vertices[i].score = getVertexScore(&vertices[i]);
+	}
+
+	std::vector<int> vertexTriangles(numberOfTriangles * 3);
+
+	for(int i = 0; i < numberOfTriangles * 3; i++){
+		CacheVertex *vertex_p = &vertices[(*indices_p)[i]];
+		vertexTriangles[vertex_p->firstTriangle + vertex_p->numberOfTriangles] = i / 3;
+		vertex_p->numberOfTriangles++;
+	}
+
+	std::vector<float> triangleScores(numberOfTriangles);
+	std::vector<bool> trianglesAdded(numberOfTriangles, false);
+
+	for(int i = 0; i < numberOfTriangles; i++){
+		triangleScores[i] = vertices[(*indices_p)[i * 3 + 0]].score + vertices[(*indices_p)[i * 3 + 1]].score + vertices[(*indices_p)[i * 3 + 2]].score;
+	}
+
+	std::vector<unsigned int> newIndices;
+	newIndices.reserve(numberOfTriangles * 3);
+
+	//one more triangle than the cache can hold, since the vertices of a new triangle are pushed in before the oldest ones fall out
+	int cache[VERTEX_CACHE_SIZE + 3];
+	int cacheLength = 0;
+
+	int bestTriangle = -1;
+	int nextUnaddedTriangle = 0;
+
+	for(int i = 0; i < numberOfTriangles; i++){
+
+		//when no triangle touches the cache the best remaining one is searched for, which only happens at the start of disconnected parts
+		if(bestTriangle == -1){
+
+			float bestScore = -1.0;
+
+			while(trianglesAdded[nextUnaddedTriangle]){
+				nextUnaddedTriangle++;
+			}
+
+			for(int j = nextUnaddedTriangle; j < numberOfTriangles; j++){
+				if(!trianglesAdded[j]
+				&& triangleScores[j] > bestScore){
+					bestScore = triangleScores[j];
+					bestTriangle = j;
+				}
+			}
+
+		}
+
+		trianglesAdded[bestTriangle] = true;
+
+		int newCache[VERTEX_CACHE_SIZE + 3];
+		int newCacheLength = 0;
+
+		for(int j = 0; j < 3; j++){
+
+			int vertexIndex = (*indices_p)[bestTriangle * 3 + j];
+			CacheVertex *vertex_p = &vertices[vertexIndex];
+
+			newIndices.push_back(vertexIndex);
+
+			newCache[newCacheLength] = vertexIndex;
+			newCacheLength++;
+
+			//the triangle is removed from the vertex by swapping it to the end of the vertex's remaining triangles
+			for(int k = 0; k < vertex_p->numberOfRemainingTriangles; k++){
+				if(vertexTriangles[vertex_p->firstTriangle + k] == bestTriangle){
+					vertexTriangles[vertex_p->firstTriangle + k] = vertexTriangles[vertex_p->firstTriangle + vertex_p->numberOfRemainingTriangles - 1];
+					vertexTriangles[vertex_p->firstTriangle + vertex_p->numberOfRemainingTriangles - 1] = bestTriangle;
+					break;
+				}
+			}
+
+			vertex_p->numberOfRemainingTriangles--;
+
+		}
+
+		for(int j = 0; j < cacheLength; j++){
+
+			int vertexIndex = cache[j];
+
+			if(vertexIndex != newCache[0]
+			&& vertexIndex != newCache[1]
+			&& vertexIndex != newCache[2]){
+				newCache[newCacheLength] = vertexIndex;
+				newCacheLength++;
+			}
+
+		}
+
+		//vertices pushed out of the cache lose their cache score
+		for(int j = VERTEX_CACHE_SIZE; j < newCacheLength; j++){
+			CacheVertex *vertex_p = &vertices[newCache[j]];
+			vertex_p->cachePosition = -1;
+			vertex_p->score = getVertexScore(vertex_p);
+		}
+
+		if(newCacheLength > VERTEX_CACHE_SIZE){
+			newCacheLength = VERTEX_CACHE_SIZE;
+		}
+
+		memcpy(cache, newCache, newCacheLength * sizeof(int));
+		cacheLength = newCacheLength;
+
+		for(int j = 0; j < cacheLength; j++){
+			CacheVertex *vertex_p = &vertices[cache[j]];
+			vertex_p->cachePosition = j;
+			vertex_p->score = getVertexScore(vertex_p);
+		}
+
+		//only triangles of vertices in the cache changed score, so the next triangle is picked among those
+		bestTriangle = -1;
+		float bestScore = -1.0;
+
+		for(int j = 0; j < cacheLength; j++){
+
+			CacheVertex *vertex_p = &vertices[cache[j]];
+
+			for(int k = 0; k < vertex_p->numberOfRemainingTriangles; k++){
+
+				int triangle = vertexTriangles[vertex_p->firstTriangle + k];
+
+				triangleScores[triangle] = vertices[(*indices_p)[triangle * 3 + 0]].score + vertices[(*indices_p)[triangle * 3 + 1]].score + vertices[(*indices_p)[triangle * 3 + 2]].score;
+
+				if(triangleScores[triangle] > bestScore){
+					bestScore = triangleScores[triangle];
+					bestTriangle = triangle;
+				}
+
+			}
+
+		}
+
+	}
+
+	indexedMesh_p->indices = newIndices;
+
+}
+
+//renumbers the vertices in the order the index buffer first uses them, so that vertex fetches move forward through memory
+void IndexedMesh_optimizeVertexFetch(IndexedMesh *indexedMesh_p){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+
+	std::vector<int> newVertexIndices(numberOfVertices, -1);
+	std::vector<float> newVertices;
+	newVertices.reserve(indexedMesh_p->vertices.size());
+
+	int numberOfNewVertices = 0;
+
+	for(int i = 0; i < indexedMesh_p->indices.size(); i++){
+
+		unsigned int vertexIndex = indexedMesh_p->indices[i];
+
+		if(newVertexIndices[vertexIndex] == -1){
+
+			newVertexIndices[vertexIndex] = numberOfNewVertices;
+			numberOfNewVertices++;
+
+			const float *vertex = &indexedMesh_p->vertices[vertexIndex * MESH_VERTEX_FLOATS];
+
+			newVertices.insert(newVertices.end(), vertex, vertex + MESH_VERTEX_FLOATS);
+
+		}
+
+		indexedMesh_p->indices[i] = newVertexIndices[vertexIndex];
+
+	}
+
+	//vertices that no triangle uses are dropped
+	indexedMesh_p->vertices = newVertices;
+
+}
+
+//simulates a FIFO post transform cache with the given number of entries
+MeshCacheStats IndexedMesh_getCacheStats(IndexedMesh *indexedMesh_p, int cacheSize){
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(indexedMesh_p);
+	int numberOfIndices = indexedMesh_p->indices.size();
+
+	//a vertex is in the cache if it was transformed within the last cacheSize transforms
+	std::vector<long int> transformTimes(numberOfVertices, -1);
+	long int numberOfTransforms = 0;
+
+	for(int i = 0; i < numberOfIndices; i++){
+
+		unsigned int vertexIndex = indexedMesh_p->indices[i];
+
+		if(transformTimes[vertexIndex] == -1
+		|| numberOfTransforms - transformTimes[vertexIndex] > cacheSize){
+			transformTimes[vertexIndex] = numberOfTransforms;
+			numberOfTransforms++;
+		}
+
+	}
+
+	MeshCacheStats stats;
+	stats.ACMR = numberOfIndices > 0 ? (float)numberOfTransforms / (float)(numberOfIndices / 3) : 0.0;
+	stats.ATVR = numberOfVertices > 0 ? (float)numberOfTransforms / (float)numberOfVertices : 0.0;
+
+	return stats;
+
+}
+
+//checks the header, that the file is as large as it says and that every index is a vertex in the file, returns false for files that are not version 1 or INDEXED_MESH_VERSION .imesh files
+bool IndexedMeshView_init(IndexedMeshView *indexedMeshView_p, const char *data, long int size){
+
+	IndexedMeshHeader *header_p = &indexedMeshView_p->header;
+
+	memset(header_p, 0, sizeof(IndexedMeshHeader));
+
+	if(size < (long int)INDEXED_MESH_VERSION_1_HEADER_SIZE){
+		printf("Indexed mesh file is too small for its header\n");
+		return false;
+	}
+
+	memcpy(header_p, data, INDEXED_MESH_VERSION_1_HEADER_SIZE);
+
+	if(memcmp(header_p->magic, INDEXED_MESH_MAGIC, 4) != 0){
+		printf("Indexed mesh file has the wrong magic number\n");
+		return false;
+	}
+
+	long int headerSize = sizeof(IndexedMeshHeader);
+
+	if(header_p->version == 1){
+		headerSize = INDEXED_MESH_VERSION_1_HEADER_SIZE;
+		header_p->vertexFormat = MESH_VERTEX_FORMAT_FLOAT;
+	}else if(header_p->version == INDEXED_MESH_VERSION){
+
+		if(size < headerSize){
+			printf("Indexed mesh file is too small for its header\n");
+			return false;
+		}
+
+		memcpy(header_p, data, headerSize);
+
+	}else{
+		printf("Indexed mesh file has version %u, expected 1 to %u\n", header_p->version, INDEXED_MESH_VERSION);
+		return false;
+	}
+
+	if(header_p->indexSize != sizeof(unsigned short)
+	&& header_p->indexSize != sizeof(unsigned int)){
+		printf("Indexed mesh file has an index size of %u\n", header_p->indexSize);
+		return false;
+	}
+
+	if(header_p->vertexFormat != MESH_VERTEX_FORMAT_FLOAT
+	&& header_p->vertexFormat != MESH_VERTEX_FORMAT_COMPACT){
+		printf("Indexed mesh file has an unknown vertex format %u\n", header_p->vertexFormat);
+		return false;
+	}
+
+	long int verticesSize = (long int)header_p->numberOfVertices * IndexedMeshView_getVertexSize(indexedMeshView_p);
+	long int indicesSize = (long int)header_p->numberOfIndices * header_p->indexSize;
+
+	if(size != headerSize + verticesSize + indicesSize){
+		printf("Indexed mesh file size does not match its header\n");
+		return false;
+	}
+
+	indexedMeshView_p->vertices = data + headerSize;
+	indexedMeshView_p->indices = data + headerSize + verticesSize;
+
+	//the indices are used to read vertices here and are drawn as they are, so an index past the vertices would read outside of the file and the vertex buffer
+	for(unsigned int i = 0; i < header_p->numberOfIndices; i++){
+		if(IndexedMeshView_getIndex(indexedMeshView_p, i) >= header_p->numberOfVertices){
+			printf("Indexed mesh file has index %u at %u, but only %u vertices\n", IndexedMeshView_getIndex(indexedMeshView_p, i), i, header_p->numberOfVertices);
+			return false;
+		}
+	}
+
+	return true;
+
+}
+
+int IndexedMeshView_getVertexSize(IndexedMeshView *indexedMeshView_p){
+
+	if(indexedMeshView_p->header.vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+		return sizeof(CompactMeshVertex);
+	}
+
+	return MESH_VERTEX_SIZE;
+
+}
+
+unsigned int IndexedMeshView_getIndex(IndexedMeshView *indexedMeshView_p, int i){
+
+	if(indexedMeshView_p->header.indexSize == sizeof(unsigned short)){
+		return ((const unsigned short *)indexedMeshView_p->indices)[i];
+	}
+
+	return ((const unsigned int *)indexedMeshView_p->indices)[i];
+
+}
+
+//writes the decoded position of a vertex to position
+void IndexedMeshView_getPosition(IndexedMeshView *indexedMeshView_p, int vertexIndex, float *position){
+
+	IndexedMeshHeader *header_p = &indexedMeshView_p->header;
+
+	if(header_p->vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+
+		const CompactMeshVertex *compactVertex_p = (const CompactMeshVertex *)indexedMeshView_p->vertices + vertexIndex;
+
+		for(int j = 0; j < 3; j++){
+			position[j] = header_p->boundsMin[j] + compactVertex_p->position[j] / 65535.0 * header_p->boundsSize[j];
+		}
+
+		return;
+
+	}
+
+	memcpy(position, (const float *)indexedMeshView_p->vertices + vertexIndex * MESH_VERTEX_FLOATS, 3 * sizeof(float));
+
+}
@@ -0,0 +1,212 @@
+#include "engine/particles.h"
+#include "engine/geometry.h"
+#include "engine/jobs.h"
+#include "engine/profiler.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+void Particles_init(Particles *particles_p){
+
+	particles_p->length = 0;
+
+	particles_p->IDs.clear();
+
+	for(int c = 0; c < 2; c++){
+		particles_p->pos[c].clear();
+		particles_p->lastPos[c].clear();
+		particles_p->velocity[c].clear();
+	}
+
+}
+
+void Particles_add(Particles *particles_p, size_t ID, Vec2f pos){
+
+	particles_p->IDs.push_back(ID);
+
+	for(int c = 0; c < 2; c++){
+		particles_p->pos[c].push_back(pos[c]);
+		particles_p->lastPos[c].push_back(pos[c]);
+		particles_p->velocity[c].push_back(0.0);
+	}
+
+	particles_p->length++;
+
+}
+
+Vec2f Particles_getPos(Particles *particles_p, int index){
+	return getVec2f(particles_p->pos[0][index], particles_p->pos[1][index]);
+}
+
+Vec2f Particles_getLastPos(Particles *particles_p, int index){
+	return getVec2f(particles_p->lastPos[0][index], particles_p->lastPos[1][index]);
+}
+
+void Particles_setPos(Particles *particles_p, int index, Vec2f pos){
+	particles_p->pos[0][index] = pos.x;
+	particles_p->pos[1][index] = pos.y;
+}
+
+//removes the marked particles in one pass, keeping the order of the rest
+void Particles_removeMarked(Particles *particles_p, std::vector<char> *removedParticles_p){
+
+	int length = 0;
+
+	for(int i = 0; i < particles_p->length; i++){
+
+		if((*removedParticles_p)[i]){
+			continue;
+		}
+
+		particles_p->IDs[length] = particles_p->IDs[i];
+
+		for(int c = 0; c < 2; c++){
+			particles_p->pos[c][length] = particles_p->pos[c][i];
+			particles_p->lastPos[c][length] = particles_p->lastPos[c][i];
+			particles_p->velocity[c][length] = particles_p->velocity[c][i];
+		}
+
+		length++;
+
+	}
+
+	particles_p->length = length;
+
+	particles_p->IDs.resize(length);
+
+	for(int c = 0; c < 2; c++){
+		particles_p->pos[c].resize(length);
+		particles_p->lastPos[c].resize(length);
+		particles_p->velocity[c].resize(length);
+	}
+
+	removedParticles_p->assign(length, 0);
+
+}
+
+typedef struct IntegrationJobData{
+	Particles *particles_p;
+	ParticleForces forces;
+}IntegrationJobData;
+
+static void integrateJob(void *data, int start, int end, int threadIndex){
+
+	PROFILER_ZONE("integrateJob");
+
+	IntegrationJobData *jobData_p = (IntegrationJobData *)data;
+
+	Particles_integrate_simd(jobData_p->particles_p, jobData_p->forces, start, end);
+
+}
+
+//applies gravity, the bending force and resistance to the velocities and stores the current positions as the last positions
+void Particles_integrate(Particles *particles_p, ParticleForces forces){
+
+	IntegrationJobData jobData;
+	jobData.particles_p = particles_p;
+	jobData.forces = forces;
+
+	//a multiple of the widest SIMD width so that only the last batch has a scalar tail
+	JobSystem_parallelFor(particles_p->length, 16384, integrateJob, &jobData);
+
+}
+
+void Particles_integrate_scalar(Particles *particles_p, ParticleForces forces, int start, int end){
+
+	float *x = particles_p->pos[0].data();
+	float *y = particles_p->pos[1].data();
+	float *lastX = particles_p->lastPos[0].data();
+	float *lastY = particles_p->lastPos[1].data();
+	float *velocityX = particles_p->velocity[0].data();
+	float *velocityY = particles_p->velocity[1].data();
+
+	float bendingForce = forces.bending ? forces.bendingForce : 0.0;
+
+	for(int i = start; i < end; i++){
+
+		float accelerationX = (forces.bendingPos.x - x[i]) * bendingForce;
+		float accelerationY = forces.gravity + (forces.bendingPos.y - y[i]) * bendingForce;
+
+		velocityX[i] = (velocityX[i] + accelerationX) * forces.resistance;
+		velocityY[i] = (velocityY[i] + accelerationY) * forces.resistance;
+
+		lastX[i] = x[i];
+		lastY[i] = y[i];
+
+	}
+
+}
+
+//same arithmetic as the scalar path, in the same order, so both give identical results
+void Particles_integrate_simd(Particles *particles_p, ParticleForces forces, int start, int end){
+
+	float *x = particles_p->pos[0].data();
+	float *y = particles_p->pos[1].data();
+	float *lastX = particles_p->lastPos[0].data();
+	float *lastY = particles_p->lastPos[1].data();
+	float *velocityX = particles_p->velocity[0].data();
+	float *velocityY = particles_p->velocity[1].data();
+
+	float bendingForce = forces.bending ? forces.bendingForce : 0.0;
+
+	int i = start;
+
+#if defined(__AVX__)
+	{
+		__m256 bendingPosX = _mm256_set1_ps(forces.bendingPos.x);
+		__m256 bendingPosY = _mm256_set1_ps(forces.bendingPos.y);
+		__m256 force = _mm256_set1_ps(bendingForce);
+		__m256 gravity = _mm256_set1_ps(forces.gravity);
+		__m256 resistance = _mm256_set1_ps(forces.resistance);
+
+		for(; i + 8 <= end; i += 8){
+
+			__m256 currentX = _mm256_loadu_ps(x + i);
+			__m256 currentY = _mm256_loadu_ps(y + i);
+
+			__m256 accelerationX = _mm256_mul_ps(_mm256_sub_ps(bendingPosX, currentX), force);
+			__m256 accelerationY = _mm256_add_ps(gravity, _mm256_mul_ps(_mm256_sub_ps(bendingPosY, currentY), force));
+
+			_mm256_storeu_ps(velocityX + i, _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocityX + i), accelerationX), resistance));
+			_mm256_storeu_ps(velocityY + i, _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocityY + i), accelerationY), resistance));
+
+			_mm256_storeu_ps(lastX + i, currentX);
+			_mm256_storeu_ps(lastY + i, currentY);
+
+		}
+	}
+#elif defined(__SSE2__)
+	{
+		__m128 bendingPosX = _mm_set1_ps(forces.bendingPos.x);
+		__m128 bendingPosY = _mm_set1_ps(forces.bendingPos.y);
+		__m128 force = _mm_set1_ps(bendingForce);
+		__m128 gravity = _mm_set1_ps(forces.gravity);
+		__m128 resistance = _mm_set1_ps(forces.resistance);
+
+		for(; i + 4 <= end; i += 4){
+
+			__m128 currentX = _mm_loadu_ps(x + i);
+			__m128 currentY = _mm_loadu_ps(y + i);
+
+			__m128 accelerationX = _mm_mul_ps(_mm_sub_ps(bendingPosX, currentX), force);
+			__m128 accelerationY = _mm_add_ps(gravity, _mm_mul_ps(_mm_sub_ps(bendingPosY, currentY), force));
+
+			_mm_storeu_ps(velocityX + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocityX + i), accelerationX), resistance));
+			_mm_storeu_ps(velocityY + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocityY + i), accelerationY), resistance));
+
+			_mm_storeu_ps(lastX + i, currentX);
+			_mm_storeu_ps(lastY + i, currentY);
+
+		}
+	}
+#endif
+
+	Particles_integrate_scalar(particles_p, forces, i, end);
+
+}
@@ -0,0 +1,274 @@
+#include "engine/profiler.h"
+#include "engine/engine.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+/*
+Every thread writes its zones to a ring buffer of its own, so recording a zone never takes a lock.
+Profiler_endFrame collects the zones of all threads since the last frame into rolling per zone frame times.
+It has to be called while no jobs are running, which is the case between Engine_update and Engine_draw calls.
+*/
+
+#define PROFILER_EVENTS_PER_THREAD 65536
+#define PROFILER_REPORT_FRAMES 300
+
+typedef struct ProfilerEvent{
+	const char *name;
+	long long startTime;
+	long long endTime;
+}ProfilerEvent;
+
+typedef struct ProfilerThreadBuffer{
+	int threadID;
+	long long numberOfEvents;
+	long long numberOfCollectedEvents;
+	ProfilerEvent events[PROFILER_EVENTS_PER_THREAD];
+}ProfilerThreadBuffer;
+
+typedef struct ProfilerZoneStats{
+	const char *name;
+	bool isCounter;
+	double frameTime;
+	bool wasInFrame;
+	std::vector<double> frameTimes;
+	int nextFrame;
+}ProfilerZoneStats;
+
+static std::mutex threadBuffersMutex;
+static std::vector<ProfilerThreadBuffer *> threadBuffers;
+static thread_local ProfilerThreadBuffer *threadBuffer_p = NULL;
+
+static std::vector<ProfilerZoneStats> zoneStats;
+
+static long long startTime = Engine_getTimeNanoseconds();
+static long long frameStartTime = 0;
+
+static ProfilerThreadBuffer *getThreadBuffer(){
+
+	if(threadBuffer_p == NULL){
+
+		threadBuffer_p = (ProfilerThreadBuffer *)malloc(sizeof(ProfilerThreadBuffer));
+		threadBuffer_p->numberOfEvents = 0;
+		threadBuffer_p->numberOfCollectedEvents = 0;
+
+		std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+		threadBuffer_p->threadID = threadBuffers.size();
+		threadBuffers.push_back(threadBuffer_p);
+
+	}
+
+	return threadBuffer_p;
+
+}
+
+static void addEvent(const char *name, long long eventStartTime, long long eventEndTime){
+
+	ProfilerThreadBuffer *buffer_p = getThreadBuffer();
+
+	ProfilerEvent *event_p = &buffer_p->events[buffer_p->numberOfEvents % PROFILER_EVENTS_PER_THREAD];
+	event_p->name = name;
+	event_p->startTime = eventStartTime;
+	event_p->endTime = eventEndTime;
+
+	__atomic_store_n(&buffer_p->numberOfEvents, buffer_p->numberOfEvents + 1, __ATOMIC_RELEASE);
+
+}
+
+Profiler_Zone::Profiler_Zone(const char *zoneName){
+	name = zoneName;
+	startTime = Engine_getTimeNanoseconds();
+}
+
+Profiler_Zone::~Profiler_Zone(){
+	addEvent(name, startTime, Engine_getTimeNanoseconds());
+}
+
+static ProfilerZoneStats *getZoneStats(const char *name){
+
+	for(int i = 0; i < zoneStats.size(); i++){
+		if(zoneStats[i].name == name
+		|| strcmp(zoneStats[i].name, name) == 0){
+			return &zoneStats[i];
+		}
+	}
+
+	ProfilerZoneStats stats;
+	stats.name = name;
+	stats.isCounter = false;
+	stats.frameTime = 0.0;
+	stats.wasInFrame = false;
+	stats.nextFrame = 0;
+
+	zoneStats.push_back(stats);
+
+	return &zoneStats.back();
+
+}
+
+void Profiler_count(const char *name, long long value){
+
+	ProfilerZoneStats *stats_p = getZoneStats(name);
+	stats_p->isCounter = true;
+	stats_p->frameTime += value;
+	stats_p->wasInFrame = true;
+
+}
+
+void Profiler_beginFrame(){
+	frameStartTime = Engine_getTimeNanoseconds();
+}
+
+void Profiler_endFrame(){
+
+	addEvent("frame", frameStartTime, Engine_getTimeNanoseconds());
+
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+	//zones that ran on several threads during the frame are summed
+	for(int i = 0; i < threadBuffers.size(); i++){
+
+		ProfilerThreadBuffer *buffer_p = threadBuffers[i];
+
+		long long numberOfEvents = __atomic_load_n(&buffer_p->numberOfEvents, __ATOMIC_ACQUIRE);
+
+		if(numberOfEvents - buffer_p->numberOfCollectedEvents > PROFILER_EVENTS_PER_THREAD){
+			buffer_p->numberOfCollectedEvents = numberOfEvents - PROFILER_EVENTS_PER_THREAD;
+		}
+
+		for(long long j = buffer_p->numberOfCollectedEvents; j < numberOfEvents; j++){
+
+			ProfilerEvent *event_p = &buffer_p->events[j % PROFILER_EVENTS_PER_THREAD];
+
+			ProfilerZoneStats *stats_p = getZoneStats(event_p->name);
+			stats_p->frameTime += (event_p->endTime - event_p->startTime) / 1000000.0;
+			stats_p->wasInFrame = true;
+
+		}
+
+		buffer_p->numberOfCollectedEvents = numberOfEvents;
+
+	}
+
+	for(int i = 0; i < zoneStats.size(); i++){
+
+		ProfilerZoneStats *stats_p = &zoneStats[i];
+
+		if(!stats_p->wasInFrame){
+			continue;
+		}
+
+		if(stats_p->frameTimes.size() < PROFILER_REPORT_FRAMES){
+			stats_p->frameTimes.push_back(stats_p->frameTime);
+		}else{
+			stats_p->frameTimes[stats_p->nextFrame] = stats_p->frameTime;
+		}
+
+		stats_p->nextFrame = (stats_p->nextFrame + 1) % PROFILER_REPORT_FRAMES;
+		stats_p->frameTime = 0.0;
+		stats_p->wasInFrame = false;
+
+	}
+
+}
+
+static void printStats(bool isCounter){
+
+	for(int i = 0; i < zoneStats.size(); i++){
+
+		ProfilerZoneStats *stats_p = &zoneStats[i];
+
+		if(stats_p->isCounter != isCounter
+		|| stats_p->frameTimes.size() == 0){
+			continue;
+		}
+
+		std::vector<double> sortedFrameTimes = stats_p->frameTimes;
+		std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+
+		double frameTimeSum = 0.0;
+		for(int j = 0; j < sortedFrameTimes.size(); j++){
+			frameTimeSum += sortedFrameTimes[j];
+		}
+
+		printf("%-36s %10.3f %10.3f %10.3f %10.3f %8i\n",
+			stats_p->name,
+			sortedFrameTimes.front(),
+			frameTimeSum / sortedFrameTimes.size(),
+			sortedFrameTimes[(sortedFrameTimes.size() - 1) * 99 / 100],
+			sortedFrameTimes.back(),
+			(int)sortedFrameTimes.size()
+		);
+
+	}
+
+}
+
+//prints the time spent in each zone and the value of each counter per frame over the last PROFILER_REPORT_FRAMES frames they were in
+void Profiler_printReport(){
+
+	printf("%-36s %10s %10s %10s %10s %8s\n", "zone", "min ms", "avg ms", "p99 ms", "max ms", "frames");
+
+	printStats(false);
+
+	printf("%-36s %10s %10s %10s %10s %8s\n", "counter", "min", "avg", "p99", "max", "frames");
+
+	printStats(true);
+
+}
+
+//writes the zones still in the ring buffers in the Chrome trace event format, which can be opened in chrome://tracing or Perfetto
+void Profiler_writeChromeTrace(const char *path){
+
+	FILE *file_p = fopen(path, "w");
+
+	if(file_p == NULL){
+		printf("Could not open trace file: %s\n", path);
+		return;
+	}
+
+	fprintf(file_p, "{\"traceEvents\":[\n");
+
+	bool isFirstEvent = true;
+
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+	for(int i = 0; i < threadBuffers.size(); i++){
+
+		ProfilerThreadBuffer *buffer_p = threadBuffers[i];
+
+		long long numberOfEvents = __atomic_load_n(&buffer_p->numberOfEvents, __ATOMIC_ACQUIRE);
+
+		long long firstEvent = numberOfEvents - PROFILER_EVENTS_PER_THREAD;
+		if(firstEvent < 0){
+			firstEvent = 0;
+		}
+
+		for(long long j = firstEvent; j < numberOfEvents; j++){
+
+			ProfilerEvent *event_p = &buffer_p->events[j % PROFILER_EVENTS_PER_THREAD];
+
+			fprintf(file_p, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}",
+				isFirstEvent ? "" : ",\n",
+				event_p->name,
+				buffer_p->threadID,
+				(event_p->startTime - startTime) / 1000.0,
+				(event_p->endTime - event_p->startTime) / 1000.0
+			);
+
+			isFirstEvent = false;
+
+		}
+
+	}
+
+	fprintf(file_p, "\n]}\n");
+
+	fclose(file_p);
+
+}
@@ -16,9 +16,26 @@
 #include "stdio.h"
 #include "math.h"
 #include "string.h"
+#include "stddef.h"
 
 //INIT FUNCTIONS
 
+static Renderer2D_ShaderUniformLocations getShaderUniformLocations(unsigned int shader){
+
+	Renderer2D_ShaderUniformLocations uniformLocations;
+
+	uniformLocations.posX = GL3D_getUniformLocation(shader, "posX");
+	uniformLocations.posY = GL3D_getUniformLocation(shader, "posY");
+	uniformLocations.width = GL3D_getUniformLocation(shader, "width");
+	uniformLocations.height = GL3D_getUniformLocation(shader, "height");
+	uniformLocations.aspectRatio = GL3D_getUniformLocation(shader, "aspectRatio");
+	uniformLocations.rotationMatrix = GL3D_getUniformLocation(shader, "rotationMatrix");
+	uniformLocations.color = GL3D_getUniformLocation(shader, "color");
+
+	return uniformLocations;
+
+}
+
 void Renderer2D_init(Renderer2D_Renderer *renderer_p, int width, int height){
 
 	glEnable(GL_BLEND);
@@ -29,6 +46,11 @@ void Renderer2D_init(Renderer2D_Renderer *renderer_p, int width, int height){
 
 	renderer_p->drawAroundCenter = false;
 
+	renderer_p->batching = false;
+	renderer_p->color = getVec4f(1.0, 1.0, 1.0, 1.0);
+	renderer_p->rotation = 0.0;
+	renderer_p->currentTextureID = 0;
+
 	static float rectangleVertices[] = {
 
 		1, 1, 		1, 0,
@@ -56,6 +78,44 @@ void Renderer2D_init(Renderer2D_Renderer *renderer_p, int width, int height){
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
 	glEnableVertexAttribArray(1);
 
+	//the instance vertex array reads the same rectangle and advances the instance attributes once per rectangle
+	renderer_p->instanceBufferSize = 1024 * sizeof(Renderer2D_RectangleInstance);
+
+	glGenBuffers(1, &renderer_p->instanceVBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, renderer_p->instanceVBO);
+
+	glBufferData(GL_ARRAY_BUFFER, renderer_p->instanceBufferSize, NULL, GL_STREAM_DRAW);
+
+	glGenVertexArrays(1, &renderer_p->instanceVAO);
+	glBindVertexArray(renderer_p->instanceVAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, renderer_p->rectangleVBO);
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, renderer_p->instanceVBO);
+
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Renderer2D_RectangleInstance), (void *)offsetof(Renderer2D_RectangleInstance, rectangle));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Renderer2D_RectangleInstance), (void *)offsetof(Renderer2D_RectangleInstance, color));
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Renderer2D_RectangleInstance), (void *)offsetof(Renderer2D_RectangleInstance, textureRegion));
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+
+	glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(Renderer2D_RectangleInstance), (void *)offsetof(Renderer2D_RectangleInstance, rotation));
+	glEnableVertexAttribArray(5);
+	glVertexAttribDivisor(5, 1);
+
 	//Font font = getFont("assets/fonts/times.ttf", 100);
 
 	//Texture_initFromText(&renderer_p->textTexture, "", font);
@@ -84,6 +144,52 @@ void Renderer2D_init(Renderer2D_Renderer *renderer_p, int width, int height){
 		
 		renderer_p->textureShader = shader;
 
+	}
+	{
+		unsigned int vertexShader = getCompiledShader("shaders/renderer2d/instanced-vertex-shader.glsl", GL_VERTEX_SHADER);
+		unsigned int fragmentShader = getCompiledShader("shaders/renderer2d/instanced-color-fragment-shader.glsl", GL_FRAGMENT_SHADER);
+
+		unsigned int shader = glCreateProgram();
+		glAttachShader(shader, vertexShader);
+		glAttachShader(shader, fragmentShader);
+		glLinkProgram(shader);
+
+		//the aspect ratio never changes, so it is set once after linking
+		glUseProgram(shader);
+		glUniform1f(GL3D_getUniformLocation(shader, "aspectRatio"), (float)width / (float)height);
+		
+		renderer_p->instancedColorShader = shader;
+
+	}
+	{
+		unsigned int vertexShader = getCompiledShader("shaders/renderer2d/instanced-vertex-shader.glsl", GL_VERTEX_SHADER);
+		unsigned int fragmentShader = getCompiledShader("shaders/renderer2d/instanced-texture-fragment-shader.glsl", GL_FRAGMENT_SHADER);
+
+		unsigned int shader = glCreateProgram();
+		glAttachShader(shader, vertexShader);
+		glAttachShader(shader, fragmentShader);
+		glLinkProgram(shader);
+
+		glUseProgram(shader);
+		glUniform1f(GL3D_getUniformLocation(shader, "aspectRatio"), (float)width / (float)height);
+		
+		renderer_p->instancedTextureShader = shader;
+
+	}
+	{
+		unsigned int vertexShader = getCompiledShader("shaders/renderer2d/instanced-vertex-shader.glsl", GL_VERTEX_SHADER);
+		unsigned int fragmentShader = getCompiledShader("shaders/renderer2d/instanced-text-fragment-shader.glsl", GL_FRAGMENT_SHADER);
+
+		unsigned int shader = glCreateProgram();
+		glAttachShader(shader, vertexShader);
+		glAttachShader(shader, fragmentShader);
+		glLinkProgram(shader);
+
+		glUseProgram(shader);
+		glUniform1f(GL3D_getUniformLocation(shader, "aspectRatio"), (float)width / (float)height);
+		
+		renderer_p->textShader = shader;
+
 	}
 	/*
 	{
@@ -122,6 +228,17 @@ void Renderer2D_init(Renderer2D_Renderer *renderer_p, int width, int height){
 
 }
 
+//rasterizes the printable ASCII characters of the font once, so that text can be drawn as batched rectangles
+void Renderer2D_Font_init(Renderer2D_Font *font_p, const char *path, int size){
+
+	Font font = getFont(path, size);
+
+	FontAtlas_init(&font_p->atlas, &font);
+
+	Texture_init(&font_p->texture, path, font_p->atlas.data, font_p->atlas.width, font_p->atlas.height);
+
+}
+
 /*
 void Renderer2D_Texture_initFromText(Renderer2D_Texture *texture_p, const char *text, Font font){
 
@@ -158,6 +275,8 @@ void Renderer2D_updateDrawSize(Renderer2D_Renderer *renderer_p, int width, int h
 
 	glViewport((int)offsetX, (int)offsetY, (int)newWidth, (int)newHeight);
 
+	GL3D_numberOfDriverCalls++;
+
 }
 
 void Renderer2D_setDrawAroundCenter(Renderer2D_Renderer *renderer_p, bool flag){
@@ -171,38 +290,144 @@ void Renderer2D_clear(Renderer2D_Renderer *renderer_p){
 	glClearColor(0.0, 0.0, 0.0, 1.0);
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	GL3D_numberOfDriverCalls += 2;
+
+}
+
+static bool isInstancedShader(Renderer2D_Renderer *renderer_p, unsigned int shader){
+	return shader == renderer_p->colorShader
+		|| shader == renderer_p->textureShader
+		|| shader == renderer_p->textShader;
 }
 
 void Renderer2D_setShader(Renderer2D_Renderer *renderer_p, unsigned int shader){
+
+	Renderer2D_flush(renderer_p);
+
+	renderer_p->currentShader = shader;
+
+	if(shader == renderer_p->colorShader){
+		glUseProgram(renderer_p->instancedColorShader);
+		GL3D_numberOfDriverCalls++;
+		return;
+	}
+	if(shader == renderer_p->textureShader){
+		glUseProgram(renderer_p->instancedTextureShader);
+		GL3D_numberOfDriverCalls++;
+		return;
+	}
+	if(shader == renderer_p->textShader){
+		glUseProgram(renderer_p->textShader);
+		GL3D_numberOfDriverCalls++;
+		return;
+	}
 	
 	glUseProgram(shader);
-	renderer_p->currentShader = shader;
+
+	//the locations are only looked up by name the first time a shader is set
+	int customShaderIndex = -1;
+
+	for(int i = 0; i < renderer_p->customShaders.size(); i++){
+		if(renderer_p->customShaders[i] == shader){
+			customShaderIndex = i;
+			break;
+		}
+	}
+
+	if(customShaderIndex == -1){
+		customShaderIndex = renderer_p->customShaders.size();
+		renderer_p->customShaders.push_back(shader);
+		renderer_p->customShaderUniformLocations.push_back(getShaderUniformLocations(shader));
+	}
+
+	renderer_p->currentUniformLocations = renderer_p->customShaderUniformLocations[customShaderIndex];
+
+	//the aspect ratio only changes with the renderer size, so it is set once per shader switch instead of per rectangle
+	glUniform1f(renderer_p->currentUniformLocations.aspectRatio, (float)renderer_p->width / (float)renderer_p->height);
+
+	GL3D_numberOfDriverCalls += 2;
 	
 }
 
 void Renderer2D_setTexture(Renderer2D_Renderer *renderer_p, Texture texture){
 
+	if(texture.ID != renderer_p->currentTextureID){
+		Renderer2D_flush(renderer_p);
+	}
+
+	renderer_p->currentTextureID = texture.ID;
+
 	glBindTexture(GL_TEXTURE_2D, texture.ID);
 
+	GL3D_numberOfDriverCalls++;
+
 }
 
 void Renderer2D_setColor(Renderer2D_Renderer *renderer_p, Vec4f color){
 
-	GL3D_uniformVec4f(renderer_p->currentShader, "color", color);
+	renderer_p->color = color;
+
+	if(!isInstancedShader(renderer_p, renderer_p->currentShader)){
+
+		glUniform4f(renderer_p->currentUniformLocations.color, color.x, color.y, color.z, color.w);
+
+		GL3D_numberOfDriverCalls++;
+
+	}
 
 }
 
 void Renderer2D_setRotation(Renderer2D_Renderer *renderer_p, float rotation){
 
-	Mat2f rotationMatrix = getRotationMat2f(rotation);
+	renderer_p->rotation = rotation;
+
+	if(!isInstancedShader(renderer_p, renderer_p->currentShader)){
+
+		Mat2f rotationMatrix = getRotationMat2f(rotation);
+
+		glUniformMatrix2fv(renderer_p->currentUniformLocations.rotationMatrix, 1, GL_FALSE, (float *)rotationMatrix.values);
+
+		GL3D_numberOfDriverCalls++;
 
-	GL3D_uniformMat2f(renderer_p->currentShader, "rotationMatrix", rotationMatrix);
+	}
+
+}
+
+static void addRectangleInstance(Renderer2D_Renderer *renderer_p, float x, float y, float width, float height, Vec4f textureRegion){
+
+	if(!renderer_p->drawAroundCenter){
+		x += width / 2.0;
+		y += height / 2.0;
+	}
+
+	Renderer2D_RectangleInstance instance;
+
+	instance.rectangle = getVec4f(
+		2 * ((float)x + renderer_p->offset.x) / (float)renderer_p->height,
+		2 * ((float)y + renderer_p->offset.y) / (float)renderer_p->height,
+		(float)width / (float)renderer_p->height,
+		(float)height / (float)renderer_p->height
+	);
+	instance.color = renderer_p->color;
+	instance.textureRegion = textureRegion;
+	instance.rotation = renderer_p->rotation;
+
+	renderer_p->instances.push_back(instance);
+
+	if(!renderer_p->batching){
+		Renderer2D_flush(renderer_p);
+	}
 
 }
 
 void Renderer2D_drawRectangle(Renderer2D_Renderer *renderer_p, float x, float y, float width, float height){
 
-	glBindBuffer(GL_ARRAY_BUFFER, renderer_p->rectangleVBO);
+	if(isInstancedShader(renderer_p, renderer_p->currentShader)){
+		addRectangleInstance(renderer_p, x, y, width, height, getVec4f(0.0, 0.0, 1.0, 1.0));
+		return;
+	}
+
+	//the vertex array keeps the attribute bindings, so the vertex buffer does not have to be bound again
 	glBindVertexArray(renderer_p->rectangleVAO);
 
 	if(!renderer_p->drawAroundCenter){
@@ -210,14 +435,110 @@ void Renderer2D_drawRectangle(Renderer2D_Renderer *renderer_p, float x, float y,
 		y += height / 2.0;
 	}
 
-	GL3D_uniformFloat(renderer_p->currentShader, "posX", 2 * ((float)x + renderer_p->offset.x) / (float)renderer_p->height);
-	GL3D_uniformFloat(renderer_p->currentShader, "posY", 2 * ((float)y + renderer_p->offset.y) / (float)renderer_p->height);
-	GL3D_uniformFloat(renderer_p->currentShader, "width", (float)width / (float)renderer_p->height);
-	GL3D_uniformFloat(renderer_p->currentShader, "height", (float)height / (float)renderer_p->height);
+	Renderer2D_ShaderUniformLocations *uniformLocations_p = &renderer_p->currentUniformLocations;
 
-	GL3D_uniformFloat(renderer_p->currentShader, "aspectRatio", (float)renderer_p->width / (float)renderer_p->height);
+	glUniform1f(uniformLocations_p->posX, 2 * ((float)x + renderer_p->offset.x) / (float)renderer_p->height);
+	glUniform1f(uniformLocations_p->posY, 2 * ((float)y + renderer_p->offset.y) / (float)renderer_p->height);
+	glUniform1f(uniformLocations_p->width, (float)width / (float)renderer_p->height);
+	glUniform1f(uniformLocations_p->height, (float)height / (float)renderer_p->height);
 
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 
+	GL3D_numberOfDriverCalls += 6;
+
+}
+
+//draws the part of the current texture given as x, y, width and height in texture coordinates, only with the built in shaders
+void Renderer2D_drawTextureRegion(Renderer2D_Renderer *renderer_p, float x, float y, float width, float height, Vec4f textureRegion){
+	addRectangleInstance(renderer_p, x, y, width, height, textureRegion);
+}
+
+//BATCHING FUNCTIONS
+
+//until Renderer2D_endBatch rectangles are collected and drawn with one instanced draw call per shader or texture change
+void Renderer2D_beginBatch(Renderer2D_Renderer *renderer_p){
+	renderer_p->batching = true;
+}
+
+void Renderer2D_flush(Renderer2D_Renderer *renderer_p){
+
+	if(renderer_p->instances.size() == 0){
+		return;
+	}
+
+	int instancesSize = renderer_p->instances.size() * sizeof(Renderer2D_RectangleInstance);
+
+	while(instancesSize > renderer_p->instanceBufferSize){
+		renderer_p->instanceBufferSize *= 2;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, renderer_p->instanceVBO);
+
+	//orphaning the buffer lets the driver give out new storage instead of waiting for draws that still read the old instances
+	glBufferData(GL_ARRAY_BUFFER, renderer_p->instanceBufferSize, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instancesSize, &renderer_p->instances[0]);
+
+	//other code may have bound another texture since the rectangles were added
+	glBindTexture(GL_TEXTURE_2D, renderer_p->currentTextureID);
+
+	glBindVertexArray(renderer_p->instanceVAO);
+
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, renderer_p->instances.size());
+
+	GL3D_numberOfDriverCalls += 6;
+
+	renderer_p->instances.clear();
+
+}
+
+void Renderer2D_endBatch(Renderer2D_Renderer *renderer_p){
+
+	Renderer2D_flush(renderer_p);
+
+	renderer_p->batching = false;
+
 }
 
+//TEXT FUNCTIONS
+
+//draws the text with its top left corner at x, y in the current color, this sets the shader to textShader and the texture to the font atlas
+void Renderer2D_drawText(Renderer2D_Renderer *renderer_p, const char *text, float x, float y, Renderer2D_Font *font_p){
+
+	if(renderer_p->currentShader != renderer_p->textShader){
+		Renderer2D_setShader(renderer_p, renderer_p->textShader);
+	}
+	if(renderer_p->currentTextureID != font_p->texture.ID){
+		Renderer2D_setTexture(renderer_p, font_p->texture);
+	}
+
+	bool drawAroundCenter = renderer_p->drawAroundCenter;
+	renderer_p->drawAroundCenter = false;
+
+	float rotation = renderer_p->rotation;
+	renderer_p->rotation = 0.0;
+
+	renderer_p->textQuads.clear();
+
+	FontAtlas_addTextQuads(&font_p->atlas, text, x, y, &renderer_p->textQuads);
+
+	bool batching = renderer_p->batching;
+	renderer_p->batching = true;
+
+	for(int i = 0; i < renderer_p->textQuads.size(); i++){
+
+		TextQuad *quad_p = &renderer_p->textQuads[i];
+
+		Renderer2D_drawTextureRegion(renderer_p, quad_p->x, quad_p->y, quad_p->width, quad_p->height, quad_p->textureRegion);
+
+	}
+
+	//outside of a batch the whole string is still drawn with one call
+	if(!batching){
+		Renderer2D_flush(renderer_p);
+	}
+
+	renderer_p->batching = batching;
+	renderer_p->drawAroundCenter = drawAroundCenter;
+	renderer_p->rotation = rotation;
+
+}
@@ -0,0 +1,256 @@
+#include "engine/replay.h"
+#include "engine/engine.h"
+#include "engine/files.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <vector>
+
+static_assert(ENGINE_KEYS_LENGTH <= 64, "input log records keep the keys in 64 bit masks");
+
+#define INPUT_LOG_POINTER_DOWN 1
+#define INPUT_LOG_POINTER_DOWNED 2
+#define INPUT_LOG_POINTER_UPPED 4
+
+static bool recording = false;
+static FileWriter recordingFileWriter;
+static InputLogRecord lastRecordedRecord;
+static int numberOfRecordedTicks = 0;
+static int numberOfRecords = 0;
+
+static std::vector<InputLogRecord> replayRecords;
+static std::vector<std::vector<char>> replayTextInputs;
+static int numberOfReplayTicks = 0;
+static int currentReplayRecord = 0;
+
+static InputLogRecord getCurrentInputLogRecord(int tick){
+
+	InputLogRecord record;
+	memset(&record, 0, sizeof(InputLogRecord));
+
+	record.tick = tick;
+
+	for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
+		record.keysDown |= (unsigned long long)Engine_keys[i].down << i;
+		record.keysDowned |= (unsigned long long)Engine_keys[i].downed << i;
+		record.keysUpped |= (unsigned long long)Engine_keys[i].upped << i;
+	}
+
+	record.pointerPos[0] = Engine_pointer.pos.x;
+	record.pointerPos[1] = Engine_pointer.pos.y;
+	record.pointerMovement[0] = Engine_pointer.movement.x;
+	record.pointerMovement[1] = Engine_pointer.movement.y;
+	record.pointerLastDownedPos[0] = Engine_pointer.lastDownedPos.x;
+	record.pointerLastDownedPos[1] = Engine_pointer.lastDownedPos.y;
+	record.pointerLastUppedPos[0] = Engine_pointer.lastUppedPos.x;
+	record.pointerLastUppedPos[1] = Engine_pointer.lastUppedPos.y;
+
+	record.pointerFlags = (Engine_pointer.down ? INPUT_LOG_POINTER_DOWN : 0)
+		| (Engine_pointer.downed ? INPUT_LOG_POINTER_DOWNED : 0)
+		| (Engine_pointer.upped ? INPUT_LOG_POINTER_UPPED : 0);
+
+	record.textInputLength = Engine_textInput.size() < 255 ? Engine_textInput.size() : 255;
+
+	return record;
+
+}
+
+//the state a tick without a record has, which is the state of the tick before without the one tick flags and text input
+static InputLogRecord getHeldInputLogRecord(InputLogRecord record, int tick){
+
+	record.tick = tick;
+	record.keysDowned = 0;
+	record.keysUpped = 0;
+	record.pointerFlags &= INPUT_LOG_POINTER_DOWN;
+	record.textInputLength = 0;
+
+	return record;
+
+}
+
+//RECORDING FUNCTIONS
+
+//the log is written to a temporary file and only replaces the file at path when InputRecorder_stop is called
+bool InputRecorder_start(const char *path){
+
+	if(!FileWriter_init(&recordingFileWriter, path)){
+		return false;
+	}
+
+	//room for the header, which is written again with the number of ticks when recording stops
+	InputLogHeader header;
+	memset(&header, 0, sizeof(InputLogHeader));
+
+	FileWriter_write(&recordingFileWriter, &header, sizeof(InputLogHeader));
+
+	memset(&lastRecordedRecord, 0, sizeof(InputLogRecord));
+	numberOfRecordedTicks = 0;
+	numberOfRecords = 0;
+
+	recording = true;
+
+	return true;
+
+}
+
+bool InputRecorder_isRecording(){
+	return recording;
+}
+
+//call with the current input state right before the Engine_update of the tick
+void InputRecorder_recordTick(int tick){
+
+	if(!recording){
+		return;
+	}
+
+	InputLogRecord record = getCurrentInputLogRecord(tick);
+
+	//the held record is moved on to the next tick also when nothing is written, so a run of equal ticks stays one record
+	if(numberOfRecordedTicks > 0
+	&& memcmp(&record, &lastRecordedRecord, sizeof(InputLogRecord)) == 0){
+		lastRecordedRecord.tick = tick + 1;
+		numberOfRecordedTicks = tick + 1;
+		return;
+	}
+
+	lastRecordedRecord = getHeldInputLogRecord(record, tick + 1);
+	numberOfRecordedTicks = tick + 1;
+	numberOfRecords++;
+
+	FileWriter_write(&recordingFileWriter, &record, sizeof(InputLogRecord));
+	FileWriter_write(&recordingFileWriter, Engine_textInput.data(), record.textInputLength);
+
+}
+
+void InputRecorder_stop(){
+
+	if(!recording){
+		return;
+	}
+
+	recording = false;
+
+	InputLogHeader header;
+	memcpy(header.magic, INPUT_LOG_MAGIC, 4);
+	header.version = INPUT_LOG_VERSION;
+	header.numberOfKeys = ENGINE_KEYS_LENGTH;
+	header.numberOfTicks = numberOfRecordedTicks;
+
+	fseek(recordingFileWriter.file_p, 0, SEEK_SET);
+
+	FileWriter_write(&recordingFileWriter, &header, sizeof(InputLogHeader));
+
+	if(FileWriter_finish(&recordingFileWriter)){
+		printf("Recorded %i ticks of input in %i records to %s\n", numberOfRecordedTicks, numberOfRecords, recordingFileWriter.path);
+	}
+
+}
+
+//REPLAY FUNCTIONS
+
+bool InputReplay_load(const char *path){
+
+	replayRecords.clear();
+	replayTextInputs.clear();
+	numberOfReplayTicks = 0;
+	currentReplayRecord = 0;
+
+	FileView fileView;
+
+	if(!FileView_init(&fileView, path)){
+		return false;
+	}
+
+	InputLogHeader header;
+
+	if(fileView.size < (long int)sizeof(InputLogHeader)){
+		printf("Input log is too small for its header: %s\n", path);
+		FileView_release(&fileView);
+		return false;
+	}
+
+	memcpy(&header, fileView.data, sizeof(InputLogHeader));
+
+	if(memcmp(header.magic, INPUT_LOG_MAGIC, 4) != 0
+	|| header.version != INPUT_LOG_VERSION
+	|| header.numberOfKeys != ENGINE_KEYS_LENGTH){
+		printf("Input log was not recorded by this version of the engine: %s\n", path);
+		FileView_release(&fileView);
+		return false;
+	}
+
+	long int offset = sizeof(InputLogHeader);
+
+	while(offset + (long int)sizeof(InputLogRecord) <= fileView.size){
+
+		InputLogRecord record;
+		memcpy(&record, fileView.data + offset, sizeof(InputLogRecord));
+
+		offset += sizeof(InputLogRecord);
+
+		if(offset + record.textInputLength > fileView.size){
+			break;
+		}
+
+		replayRecords.push_back(record);
+		replayTextInputs.push_back(std::vector<char>(fileView.data + offset, fileView.data + offset + record.textInputLength));
+
+		offset += record.textInputLength;
+
+	}
+
+	if(offset != fileView.size){
+		printf("Input log ends in the middle of a record: %s\n", path);
+	}
+
+	numberOfReplayTicks = header.numberOfTicks;
+
+	FileView_release(&fileView);
+
+	return true;
+
+}
+
+int InputReplay_getNumberOfTicks(){
+	return numberOfReplayTicks;
+}
+
+//sets the input state to what it was on the tick, ticks have to be applied in order starting from 0
+void InputReplay_applyTick(int tick){
+
+	InputLogRecord record;
+	memset(&record, 0, sizeof(InputLogRecord));
+
+	Engine_textInput.clear();
+
+	if(currentReplayRecord < replayRecords.size()
+	&& replayRecords[currentReplayRecord].tick == tick){
+
+		record = replayRecords[currentReplayRecord];
+
+		Engine_textInput = replayTextInputs[currentReplayRecord];
+
+		currentReplayRecord++;
+
+	}else if(currentReplayRecord > 0){
+		record = getHeldInputLogRecord(replayRecords[currentReplayRecord - 1], tick);
+	}
+
+	for(int i = 0; i < ENGINE_KEYS_LENGTH; i++){
+		Engine_keys[i].down = (record.keysDown >> i) & 1;
+		Engine_keys[i].downed = (record.keysDowned >> i) & 1;
+		Engine_keys[i].upped = (record.keysUpped >> i) & 1;
+	}
+
+	Engine_pointer.pos = getVec2f(record.pointerPos[0], record.pointerPos[1]);
+	Engine_pointer.movement = getVec2f(record.pointerMovement[0], record.pointerMovement[1]);
+	Engine_pointer.lastDownedPos = getVec2f(record.pointerLastDownedPos[0], record.pointerLastDownedPos[1]);
+	Engine_pointer.lastUppedPos = getVec2f(record.pointerLastUppedPos[0], record.pointerLastUppedPos[1]);
+
+	Engine_pointer.down = record.pointerFlags & INPUT_LOG_POINTER_DOWN;
+	Engine_pointer.downed = record.pointerFlags & INPUT_LOG_POINTER_DOWNED;
+	Engine_pointer.upped = record.pointerFlags & INPUT_LOG_POINTER_UPPED;
+
+}
@@ -0,0 +1,176 @@
+#include "engine/spatialhash.h"
+
+#include "math.h"
+#include <algorithm>
+
+void SpatialHash_init(SpatialHash *spatialHash_p, float cellSize, int numberOfBuckets){
+
+	spatialHash_p->cellSize = cellSize;
+	spatialHash_p->numberOfBuckets = numberOfBuckets;
+	spatialHash_p->queryStamp = 0;
+
+	SpatialHash_clear(spatialHash_p);
+
+}
+
+void SpatialHash_clear(SpatialHash *spatialHash_p){
+
+	spatialHash_p->itemPositions.clear();
+	spatialHash_p->itemSizes.clear();
+
+	spatialHash_p->bucketStarts.assign(spatialHash_p->numberOfBuckets + 1, 0);
+	spatialHash_p->bucketItems.clear();
+
+}
+
+int SpatialHash_add(SpatialHash *spatialHash_p, Vec2f pos, Vec2f size){
+
+	spatialHash_p->itemPositions.push_back(pos);
+	spatialHash_p->itemSizes.push_back(size);
+
+	return spatialHash_p->itemPositions.size() - 1;
+
+}
+
+static int getCell(SpatialHash *spatialHash_p, float x){
+	return (int)floorf(x / spatialHash_p->cellSize);
+}
+
+static int getBucket(SpatialHash *spatialHash_p, int cellX, int cellY){
+	return ((unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u) & (spatialHash_p->numberOfBuckets - 1);
+}
+
+//calls the function with the bucket of every cell the box touches
+template<typename Function>
+static void forEachBucket(SpatialHash *spatialHash_p, Vec2f pos, Vec2f size, Function function){
+
+	int startX = getCell(spatialHash_p, pos.x);
+	int startY = getCell(spatialHash_p, pos.y);
+	int endX = getCell(spatialHash_p, pos.x + size.x);
+	int endY = getCell(spatialHash_p, pos.y + size.y);
+
+	for(int y = startY; y <= endY; y++){
+		for(int x = startX; x <= endX; x++){
+			function(getBucket(spatialHash_p, x, y));
+		}
+	}
+
+}
+
+void SpatialHash_build(SpatialHash *spatialHash_p){
+
+	std::vector<int> *bucketStarts_p = &spatialHash_p->bucketStarts;
+	int numberOfItems = spatialHash_p->itemPositions.size();
+
+	bucketStarts_p->assign(spatialHash_p->numberOfBuckets + 1, 0);
+
+	//count the items in each bucket, then turn the counts into where each bucket starts
+	for(int i = 0; i < numberOfItems; i++){
+		forEachBucket(spatialHash_p, spatialHash_p->itemPositions[i], spatialHash_p->itemSizes[i], [&](int bucket){
+			(*bucketStarts_p)[bucket + 1]++;
+		});
+	}
+
+	for(int i = 0; i < spatialHash_p->numberOfBuckets; i++){
+		(*bucketStarts_p)[i + 1] += (*bucketStarts_p)[i];
+	}
+
+	spatialHash_p->bucketItems.resize(bucketStarts_p->back());
+
+	//items are placed in the order they were added, so every bucket is sorted
+	spatialHash_p->bucketEnds.assign(bucketStarts_p->begin(), bucketStarts_p->end() - 1);
+
+	for(int i = 0; i < numberOfItems; i++){
+		forEachBucket(spatialHash_p, spatialHash_p->itemPositions[i], spatialHash_p->itemSizes[i], [&](int bucket){
+			spatialHash_p->bucketItems[spatialHash_p->bucketEnds[bucket]] = i;
+			spatialHash_p->bucketEnds[bucket]++;
+		});
+	}
+
+	spatialHash_p->itemQueryStamps.assign(numberOfItems, 0);
+	spatialHash_p->queryStamp = 0;
+
+}
+
+//collects the items in the buckets the box touches, an item that is in several of them or that shares a bucket with the same cell twice is only added once
+static void collectCandidates(SpatialHash *spatialHash_p, Vec2f pos, Vec2f size, std::vector<int> *candidates_p){
+
+	spatialHash_p->queryStamp++;
+
+	forEachBucket(spatialHash_p, pos, size, [&](int bucket){
+		for(int i = spatialHash_p->bucketStarts[bucket]; i < spatialHash_p->bucketStarts[bucket + 1]; i++){
+
+			int item = spatialHash_p->bucketItems[i];
+
+			if(spatialHash_p->itemQueryStamps[item] != spatialHash_p->queryStamp){
+				spatialHash_p->itemQueryStamps[item] = spatialHash_p->queryStamp;
+				candidates_p->push_back(item);
+			}
+
+		}
+	});
+
+}
+
+void SpatialHash_queryBox(SpatialHash *spatialHash_p, Vec2f pos, Vec2f size, std::vector<int> *items_p){
+
+	size_t firstItem = items_p->size();
+
+	collectCandidates(spatialHash_p, pos, size, items_p);
+
+	size_t numberOfItems = firstItem;
+
+	for(size_t i = firstItem; i < items_p->size(); i++){
+
+		int item = (*items_p)[i];
+
+		Vec2f itemPos = spatialHash_p->itemPositions[item];
+		Vec2f itemSize = spatialHash_p->itemSizes[item];
+
+		if(itemPos.x < pos.x + size.x
+		&& itemPos.x + itemSize.x > pos.x
+		&& itemPos.y < pos.y + size.y
+		&& itemPos.y + itemSize.y > pos.y){
+			(*items_p)[numberOfItems] = item;
+			numberOfItems++;
+		}
+
+	}
+
+	items_p->resize(numberOfItems);
+
+	std::sort(items_p->begin() + firstItem, items_p->end());
+
+}
+
+void SpatialHash_queryRadius(SpatialHash *spatialHash_p, Vec2f center, float radius, std::vector<int> *items_p){
+
+	size_t firstItem = items_p->size();
+
+	collectCandidates(spatialHash_p, getVec2f(center.x - radius, center.y - radius), getVec2f(radius * 2.0, radius * 2.0), items_p);
+
+	size_t numberOfItems = firstItem;
+
+	for(size_t i = firstItem; i < items_p->size(); i++){
+
+		int item = (*items_p)[i];
+
+		Vec2f itemPos = spatialHash_p->itemPositions[item];
+		Vec2f itemSize = spatialHash_p->itemSizes[item];
+
+		//the distance from the center to the closest point of the box
+		float distanceX = fmaxf(itemPos.x - center.x, fmaxf(0.0, center.x - (itemPos.x + itemSize.x)));
+		float distanceY = fmaxf(itemPos.y - center.y, fmaxf(0.0, center.y - (itemPos.y + itemSize.y)));
+
+		if(distanceX * distanceX + distanceY * distanceY <= radius * radius){
+			(*items_p)[numberOfItems] = item;
+			numberOfItems++;
+		}
+
+	}
+
+	items_p->resize(numberOfItems);
+
+	std::sort(items_p->begin() + firstItem, items_p->end());
+
+}
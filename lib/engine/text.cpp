@@ -7,6 +7,8 @@
 #include "stdbool.h"
 #include "math.h"
 #include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
 
 Font getFont(const char *fontPath, int fontSize){
 
@@ -92,14 +94,16 @@ char *getImageDataFromFontAndString_mustFree(Font font, const char *string, int
 	//texture.width = 0;
 	//texture.height = font.size;
 
-	for(int i = 0; i < strlen(string); i++){
+	int length = strlen(string);
+
+	for(int i = 0; i < length; i++){
 
 		width += roundf(font.glyphs[string[i]].width * font.scale);
 
 		int kern;
 		kern = stbtt_GetCodepointKernAdvance(&font.info, string[i], string[i + 1]);
-		if(i == strlen(string) - 1){
-			kern = stbtt_GetCodepointKernAdvance(&font.info, string[i], (size_t)" ");
+		if(i == length - 1){
+			kern = stbtt_GetCodepointKernAdvance(&font.info, string[i], ' ');
 			width += 1;
 		}
 
@@ -111,7 +115,7 @@ char *getImageDataFromFontAndString_mustFree(Font font, const char *string, int
 	memset(bitmap, 0, width * height * sizeof(unsigned char));
 
 	int x = 0;
-	for(int i = 0; i < strlen(string); i++){
+	for(int i = 0; i < length; i++){
 
 		Glyph glyph = font.glyphs[string[i]];
 		
@@ -164,3 +168,187 @@ char *getImageDataFromFontAndString_mustFree(Font font, const char *string, int
 	//return texture;
 
 }
+
+//FONT ATLAS
+
+static int getAtlasIndex(char character){
+
+	int index = (unsigned char)character - FONT_ATLAS_FIRST_CHARACTER;
+
+	if(index < 0
+	|| index >= FONT_ATLAS_NUMBER_OF_CHARACTERS){
+		return 0;
+	}
+
+	return index;
+
+}
+
+void FontAtlas_init(FontAtlas *atlas_p, Font *font_p){
+
+	atlas_p->size = font_p->size;
+	atlas_p->ascent = font_p->ascent;
+	atlas_p->descent = font_p->descent;
+	atlas_p->lineGap = font_p->lineGap;
+
+	unsigned char *bitmaps[FONT_ATLAS_NUMBER_OF_CHARACTERS];
+
+	for(int i = 0; i < FONT_ATLAS_NUMBER_OF_CHARACTERS; i++){
+
+		int character = FONT_ATLAS_FIRST_CHARACTER + i;
+		AtlasGlyph *glyph_p = &atlas_p->glyphs[i];
+
+		bitmaps[i] = stbtt_GetCodepointBitmap(&font_p->info, font_p->scale, font_p->scale, character, &glyph_p->width, &glyph_p->height, &glyph_p->offsetX, &glyph_p->offsetY);
+
+		int advance, leftSideBearing;
+		stbtt_GetCodepointHMetrics(&font_p->info, character, &advance, &leftSideBearing);
+
+		glyph_p->advance = advance * font_p->scale;
+
+		for(int j = 0; j < FONT_ATLAS_NUMBER_OF_CHARACTERS; j++){
+			atlas_p->kerning[i][j] = stbtt_GetCodepointKernAdvance(&font_p->info, character, FONT_ATLAS_FIRST_CHARACTER + j) * font_p->scale;
+		}
+
+	}
+
+	//glyphs are packed in rows from left to right with a pixel of space between them so that they never bleed into each other
+	atlas_p->width = 16 * (font_p->size + 1);
+
+	int x = 1;
+	int y = 1;
+	int rowHeight = 0;
+	int glyphX[FONT_ATLAS_NUMBER_OF_CHARACTERS];
+	int glyphY[FONT_ATLAS_NUMBER_OF_CHARACTERS];
+
+	for(int i = 0; i < FONT_ATLAS_NUMBER_OF_CHARACTERS; i++){
+
+		AtlasGlyph *glyph_p = &atlas_p->glyphs[i];
+
+		if(x + glyph_p->width + 1 > atlas_p->width){
+			x = 1;
+			y += rowHeight + 1;
+			rowHeight = 0;
+		}
+
+		glyphX[i] = x;
+		glyphY[i] = y;
+
+		x += glyph_p->width + 1;
+
+		if(glyph_p->height > rowHeight){
+			rowHeight = glyph_p->height;
+		}
+
+	}
+
+	atlas_p->height = y + rowHeight + 1;
+
+	atlas_p->data = (unsigned char *)calloc(atlas_p->width * atlas_p->height * 4, sizeof(unsigned char));
+
+	for(int i = 0; i < FONT_ATLAS_NUMBER_OF_CHARACTERS; i++){
+
+		AtlasGlyph *glyph_p = &atlas_p->glyphs[i];
+
+		for(int glyphRow = 0; glyphRow < glyph_p->height; glyphRow++){
+			for(int glyphColumn = 0; glyphColumn < glyph_p->width; glyphColumn++){
+
+				unsigned char *pixel_p = atlas_p->data + ((glyphY[i] + glyphRow) * atlas_p->width + glyphX[i] + glyphColumn) * 4;
+
+				pixel_p[0] = 255;
+				pixel_p[1] = 255;
+				pixel_p[2] = 255;
+				pixel_p[3] = bitmaps[i][glyphRow * glyph_p->width + glyphColumn];
+
+			}
+		}
+
+		glyph_p->textureRegion = getVec4f(
+			(float)glyphX[i] / (float)atlas_p->width,
+			(float)glyphY[i] / (float)atlas_p->height,
+			(float)glyph_p->width / (float)atlas_p->width,
+			(float)glyph_p->height / (float)atlas_p->height
+		);
+
+		stbtt_FreeBitmap(bitmaps[i], NULL);
+
+	}
+
+}
+
+void FontAtlas_free(FontAtlas *atlas_p){
+	free(atlas_p->data);
+}
+
+//returns the width of the widest line
+float FontAtlas_getTextWidth(FontAtlas *atlas_p, const char *text){
+
+	float width = 0.0;
+	float lineWidth = 0.0;
+
+	for(int i = 0; text[i] != '\0'; i++){
+
+		if(text[i] == '\n'){
+			lineWidth = 0.0;
+			continue;
+		}
+
+		int index = getAtlasIndex(text[i]);
+
+		lineWidth += atlas_p->glyphs[index].advance;
+
+		if(text[i + 1] != '\0'
+		&& text[i + 1] != '\n'){
+			lineWidth += atlas_p->kerning[index][getAtlasIndex(text[i + 1])];
+		}
+
+		if(lineWidth > width){
+			width = lineWidth;
+		}
+
+	}
+
+	return width;
+
+}
+
+//adds one quad per visible glyph with x, y as the top left corner of the text, lines are split on \n
+void FontAtlas_addTextQuads(FontAtlas *atlas_p, const char *text, float x, float y, std::vector<TextQuad> *quads_p){
+
+	float penX = x;
+	float baseline = y + atlas_p->ascent;
+
+	for(int i = 0; text[i] != '\0'; i++){
+
+		if(text[i] == '\n'){
+			penX = x;
+			baseline += atlas_p->ascent - atlas_p->descent + atlas_p->lineGap;
+			continue;
+		}
+
+		int index = getAtlasIndex(text[i]);
+		AtlasGlyph *glyph_p = &atlas_p->glyphs[index];
+
+		if(glyph_p->width > 0
+		&& glyph_p->height > 0){
+
+			TextQuad quad;
+			quad.x = roundf(penX) + glyph_p->offsetX;
+			quad.y = baseline + glyph_p->offsetY;
+			quad.width = glyph_p->width;
+			quad.height = glyph_p->height;
+			quad.textureRegion = glyph_p->textureRegion;
+
+			quads_p->push_back(quad);
+
+		}
+
+		penX += glyph_p->advance;
+
+		if(text[i + 1] != '\0'
+		&& text[i + 1] != '\n'){
+			penX += atlas_p->kerning[index][getAtlasIndex(text[i + 1])];
+		}
+
+	}
+
+}
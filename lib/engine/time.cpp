@@ -0,0 +1,28 @@
+#include "engine/engine.h"
+
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include "time.h"
+#endif
+
+//TIME FUNCTIONS
+
+//nanoseconds on a clock that is not affected by changes to the system time, the frame pacer, the headless runner and the profiler all use this one
+long long Engine_getTimeNanoseconds(){
+
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+
+	return counter.QuadPart / frequency.QuadPart * 1000000000LL + counter.QuadPart % frequency.QuadPart * 1000000000LL / frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (long long)time.tv_sec * 1000000000LL + time.tv_nsec;
+#endif
+
+}
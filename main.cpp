@@ -4,6 +4,12 @@
 #include "engine/shaders.h"
 #include "engine/renderer2d.h"
 #include "engine/strings.h"
+#include "engine/particles.h"
+#include "engine/jobs.h"
+#include "engine/profiler.h"
+#include "engine/files.h"
+#include "engine/compression.h"
+#include "engine/spatialhash.h"
 
 #include "stdio.h"
 #include "stdlib.h"
@@ -11,6 +17,7 @@
 #include "time.h"
 #include <cstring>
 #include <vector>
+#include <mutex>
 
 enum EntityType{
 	ENTITY_TYPE_PLAYER,
@@ -44,15 +51,6 @@ struct Entity{
 	enum EntityType type;
 };
 
-struct Particle{
-	size_t ID;
-	Vec2f pos;
-	Vec2f lastPos;
-	Vec2f velocity;
-	Vec2f acceleration;
-	Vec2f resistance;
-};
-
 struct Pixel{
 	unsigned char r;
 	unsigned char g;
@@ -68,16 +66,28 @@ struct Pixel{
 	}
 };
 
-Pixel BACKGROUND_COLOR = { 0, 0, 0, 255 };
-Pixel ROCK_COLOR = { 255, 255, 255, 255 };
-Pixel STATIC_ROCK_COLOR = { 100, 100, 100, 255 };
-Pixel WATER_COLOR = { 100, 100, 255, 255 };
+//the grid stores one byte per cell, colors are only looked up when drawing
+enum Material{
+	MATERIAL_BACKGROUND,
+	MATERIAL_ROCK,
+	MATERIAL_STATIC_ROCK,
+	MATERIAL_WATER,
+	NUMBER_OF_MATERIALS,
+};
+
+Pixel MATERIAL_COLORS[NUMBER_OF_MATERIALS] = {
+	{ 0, 0, 0, 255 },
+	{ 255, 255, 255, 255 },
+	{ 100, 100, 100, 255 },
+	{ 100, 100, 255, 255 },
+};
 
 Vec4f PLAYER_COLOR = { 0.0, 0.0, 1.0, 1.0 };
 Vec4f ENEMY_COLOR = { 1.0, 0.0, 0.0, 1.0 };
 Vec4f BULLET_COLOR = { 1.0, 1.0, 0.0, 1.0 };
 
 float PARTICLE_GRAVITY = 0.1;
+float PARTICLE_RESISTANCE = 0.97;
 float PARTICLE_COLLISION_DAMPENING = 0.7;
 
 float PLAYER_GRAVITY = 0.15;
@@ -102,16 +112,72 @@ Renderer2D_Renderer renderer;
 
 std::vector<Entity> entities;
 
-int GRID_WIDTH = 480 * 4;
-int GRID_HEIGHT = 270 * 4;
+//the bodies of the entities others look for, which are the players, rebuilt before the passes that look for them
+const float TARGET_SPATIAL_HASH_CELL_SIZE = 32.0;
+const int TARGET_SPATIAL_HASH_BUCKETS = 1024;
+
+SpatialHash targetSpatialHash;
+std::vector<int> targetEntityIndices;
+std::vector<int> targetQueryResults;
+std::vector<char> removedEntities;
+
+#ifndef WORLD_SCALE
+#define WORLD_SCALE 1
+#endif
+
+int GRID_WIDTH = 480 * 4 * WORLD_SCALE;
+int GRID_HEIGHT = 270 * 4 * WORLD_SCALE;
 
-std::vector<Particle> particles;
+Particles particles;
+
+//the grid is stored in square chunks that are allocated when something is written to them, a missing chunk is empty
+const int GRID_CHUNK_SIZE_BITS = 6;
+const int GRID_CHUNK_SIZE = 1 << GRID_CHUNK_SIZE_BITS;
+const int GRID_CHUNK_AREA = GRID_CHUNK_SIZE * GRID_CHUNK_SIZE;
+
+//every row and column of a chunk also has a bit per cell for what occupies it, so bodies and searches can test a whole line of cells at once
+//particles are only kept in the lines along the axis of the collision pass that put them into the collision index grid
+static_assert(GRID_CHUNK_SIZE == 64, "the occupancy of a chunk row or column is kept in one 64 bit word");
+
+enum GridOccupancy{
+	GRID_OCCUPANCY_SOLID,
+	GRID_OCCUPANCY_STATIC,
+	GRID_OCCUPANCY_PARTICLE,
+	NUMBER_OF_GRID_OCCUPANCIES,
+};
 
-Pixel *drawingGrid;
-Pixel *staticParticlesGrid;
-int *collisionIndexGrid;
-int *emptyCollisionIndexGrid;
-Texture gridTexture;
+typedef struct GridChunk{
+	unsigned char staticParticles[GRID_CHUNK_AREA];
+	int collisionIndices[GRID_CHUNK_AREA];
+	unsigned long long occupancyRows[NUMBER_OF_GRID_OCCUPANCIES][GRID_CHUNK_SIZE];
+	unsigned long long occupancyColumns[NUMBER_OF_GRID_OCCUPANCIES][GRID_CHUNK_SIZE];
+	int numberOfStaticCells;
+	int numberOfEmptyTicks;
+	char hasCollisionIndices;
+	char hasParticleOccupancy;
+	char hasStaleCrossingOccupancies;
+	char dirty;
+	bool hasDrawnParticles;
+	bool needsUpload;
+	bool hasTexture;
+	Pixel *drawing;
+	Texture texture;
+}GridChunk;
+
+int GRID_CHUNKS_WIDTH = (GRID_WIDTH + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+int GRID_CHUNKS_HEIGHT = (GRID_HEIGHT + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+
+//chunks stay around for a while after they get empty, since particles often pass back into them right away
+int GRID_CHUNK_EMPTY_TICKS_BEFORE_FREE = 60;
+
+std::vector<GridChunk *> gridChunks(GRID_CHUNKS_WIDTH * GRID_CHUNKS_HEIGHT, NULL);
+
+std::vector<Vec2f> chunklessDrawnParticles;
+std::mutex gridChunksMutex;
+
+std::vector<std::vector<int *>> collisionIndexGridWrittenCells;
+std::vector<std::vector<GridChunk *>> particleOccupancyWrittenChunks;
+std::vector<std::vector<GridChunk *>> staleCrossingOccupancyChunks;
 
 Vec2f bendingPos;
 bool isBending = false;
@@ -121,993 +187,2303 @@ float BIG_BENDING_RADIUS = 80;
 
 float CAMERA_SPEED = 20;
 Vec2f cameraPos;
+Vec2f lastCameraPos;
 Vec2f cameraDest;
 
 size_t currentParticleID = 0;
 
+std::vector<char> removedParticles;
+
+//world snapshots are a header followed by the run length encoded chunks, the particle arrays and the entities
+#define WORLD_SNAPSHOT_MAGIC "BWLD"
+#define WORLD_SNAPSHOT_VERSION 1
+
+typedef struct WorldSnapshotHeader{
+	char magic[4];
+	unsigned int version;
+	int gridWidth;
+	int gridHeight;
+	int gridChunkSize;
+	int numberOfChunks;
+	int numberOfParticles;
+	int numberOfEntities;
+	unsigned long long currentParticleID;
+	Vec2f cameraPos;
+	Vec2f cameraDest;
+}WorldSnapshotHeader;
+
+//each chunk in a snapshot starts with this, followed by the encoded static particles
+typedef struct WorldSnapshotChunkHeader{
+	int chunkIndex;
+	int encodedSize;
+}WorldSnapshotChunkHeader;
+
+typedef struct ParticleLines{
+	std::vector<int> starts;
+	std::vector<int> ends;
+	std::vector<int> particleIndices;
+	std::vector<int> particleLine;
+	std::vector<int> oubParticleIndices;
+}ParticleLines;
+
+ParticleLines particleLines;
+
+int PARTICLES_PER_JOB = 16384;
+int PARTICLE_LINES_PER_JOB = 8;
+
 bool firstFrame = true;
 
-int getGridIndex(Vec2f pos){
-	return GRID_WIDTH * (int)pos.y + (int)pos.x;
-}
+//performance overlay, toggled with H
+Renderer2D_Font hudFont;
+bool showHud = false;
+float lastUpdateTime = 0.0;
 
-Vec2f getGridPos(int index){
-	return getVec2f((int)(index / GRID_WIDTH), index % GRID_WIDTH);
+//positions are drawn between where they were before the last update and where they are now
+Vec2f getInterpolatedVec2f(Vec2f lastPos, Vec2f pos, float alpha){
+	return getVec2f(lastPos.x + (pos.x - lastPos.x) * alpha, lastPos.y + (pos.y - lastPos.y) * alpha);
 }
 
 bool checkOub(Vec2f pos){
 	return pos.x < 0 || pos.y < 0 || pos.x >= GRID_WIDTH || pos.y >= GRID_HEIGHT;
 }
 
-void Body_init(Body *body_p, Vec2f pos, Vec2f size){
-	body_p->pos = pos;
-	body_p->size = size;
-}
+//GRID CHUNKS
+//all grid accesses go through these functions and expect a position that is not oub
 
-bool checkBodyVec2fCol(Body body, Vec2f v){
-	return v.x >= body.pos.x
-		&& v.x < body.pos.x + body.size.x
-		&& v.y >= body.pos.y
-		&& v.y < body.pos.y + body.size.y;
+int getGridChunkIndex(Vec2f pos){
+	return GRID_CHUNKS_WIDTH * ((int)pos.y >> GRID_CHUNK_SIZE_BITS) + ((int)pos.x >> GRID_CHUNK_SIZE_BITS);
 }
 
-void Physics_init(Physics *physics_p){
-	physics_p->velocity = getVec2f(0.0, 0.0);
-	physics_p->acceleration = getVec2f(0.0, 0.0);
-	physics_p->resistance = getVec2f(1.0, 1.0);
+int getGridChunkCellIndex(Vec2f pos){
+	return (((int)pos.y & (GRID_CHUNK_SIZE - 1)) << GRID_CHUNK_SIZE_BITS) + ((int)pos.x & (GRID_CHUNK_SIZE - 1));
 }
 
-void Particle_init(Particle *particle_p, Vec2f pos){
-
-	particle_p->ID = currentParticleID;
-	currentParticleID++;
-
-	particle_p->pos = pos;
-	particle_p->velocity = getVec2f(0.0, 0.0);
-	particle_p->acceleration = getVec2f(0.0, 0.0);
-	particle_p->resistance = getVec2f(0.97, 0.97);
+//returns NULL if the chunk is empty
+GridChunk *getGridChunk(Vec2f pos){
+	return __atomic_load_n(&gridChunks[getGridChunkIndex(pos)], __ATOMIC_ACQUIRE);
 }
 
-void Entity_init(Entity *entity_p, Vec2f pos, Vec2f size, enum EntityType type){
+//chunks can be added from several threads during the collision passes, so adding is locked while lookups are not
+GridChunk *getOrAddGridChunk(Vec2f pos){
 
-	Body_init(&entity_p->body, pos, size);
-	Physics_init(&entity_p->physics);
+	int chunkIndex = getGridChunkIndex(pos);
 
-	entity_p->type = type;
+	GridChunk *chunk_p = __atomic_load_n(&gridChunks[chunkIndex], __ATOMIC_ACQUIRE);
 
-}
+	if(chunk_p != NULL){
+		return chunk_p;
+	}
 
-void addPlayer(Vec2f pos){
+	std::lock_guard<std::mutex> lock(gridChunksMutex);
 
-	Entity entity;
+	chunk_p = __atomic_load_n(&gridChunks[chunkIndex], __ATOMIC_ACQUIRE);
 
-	Entity_init(&entity, pos, getVec2f(15.0, 20.0), ENTITY_TYPE_PLAYER);
-	entity.physics.resistance.x = PLAYER_WALK_RESISTANCE;
+	if(chunk_p == NULL){
 
-	entities.push_back(entity);
+		chunk_p = (GridChunk *)malloc(sizeof(GridChunk));
 
-}
+		for(int i = 0; i < GRID_CHUNK_AREA; i++){
+			chunk_p->staticParticles[i] = MATERIAL_BACKGROUND;
+			chunk_p->collisionIndices[i] = -1;
+		}
 
-void addEnemy(Vec2f pos){
+		memset(chunk_p->occupancyRows, 0, sizeof(chunk_p->occupancyRows));
+		memset(chunk_p->occupancyColumns, 0, sizeof(chunk_p->occupancyColumns));
 
-	Entity entity;
+		chunk_p->numberOfStaticCells = 0;
+		chunk_p->numberOfEmptyTicks = 0;
+		chunk_p->hasCollisionIndices = 0;
+		chunk_p->hasParticleOccupancy = 0;
+		chunk_p->hasStaleCrossingOccupancies = 0;
+		chunk_p->dirty = 1;
+		chunk_p->hasDrawnParticles = false;
+		chunk_p->needsUpload = false;
+		chunk_p->hasTexture = false;
+		chunk_p->drawing = NULL;
 
-	Entity_init(&entity, pos, getVec2f(15.0, 20.0), ENTITY_TYPE_ENEMY);
+		__atomic_store_n(&gridChunks[chunkIndex], chunk_p, __ATOMIC_RELEASE);
 
-	entity.physics.resistance.x = ENEMY_WALK_RESISTANCE;
+	}
 
-	entities.push_back(entity);
+	return chunk_p;
 
 }
 
-void addBullet(Vec2f pos, Vec2f velocity){
-
-	Entity entity;
+void freeGridChunk(int chunkIndex){
 
-	Entity_init(&entity, pos, getVec2f(10.0, 10.0), ENTITY_TYPE_BULLET);
+	GridChunk *chunk_p = gridChunks[chunkIndex];
 
-	entity.physics.velocity = velocity;
+	if(chunk_p->hasTexture){
+		Texture_free(&chunk_p->texture);
+		free(chunk_p->drawing);
+	}
 
-	entities.push_back(entity);
+	free(chunk_p);
 
+	gridChunks[chunkIndex] = NULL;
 
 }
 
-void paintArea(int inputX, int inputY, int w, int h, Pixel color){
-	for(int x = 0; x < w; x++){
-		for(int y = 0; y < h; y++){
+//frees chunks without static particles that have had no particles in them during the collision passes of the last GRID_CHUNK_EMPTY_TICKS_BEFORE_FREE ticks
+void freeEmptyGridChunks(){
 
-			Vec2f pos = getVec2f(inputX + x, inputY + y);
-			int index = getGridIndex(pos);
+	PROFILER_ZONE("freeEmptyGridChunks");
 
-			if(!checkOub(pos)){
-				staticParticlesGrid[index] = color;
-			}
+	for(int i = 0; i < gridChunks.size(); i++){
 
-		}
-	}
-}
+		GridChunk *chunk_p = gridChunks[i];
 
-void Engine_start(){
+		if(chunk_p == NULL){
+			continue;
+		}
 
-	printf("Starting the engine\n");
+		if(chunk_p->numberOfStaticCells == 0
+		&& !chunk_p->hasCollisionIndices){
+			chunk_p->numberOfEmptyTicks++;
+		}else{
+			chunk_p->numberOfEmptyTicks = 0;
+		}
 
-	Engine_setWindowSize(WIDTH * 2, HEIGHT * 2);
+		if(chunk_p->numberOfEmptyTicks > GRID_CHUNK_EMPTY_TICKS_BEFORE_FREE){
+			freeGridChunk(i);
+			continue;
+		}
 
-	Engine_centerWindow();
+		chunk_p->hasCollisionIndices = 0;
 
-	Renderer2D_init(&renderer, WIDTH, HEIGHT);
+	}
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
 
-	//init world
-	addPlayer(getVec2f(100.0, GRID_HEIGHT - 200.0));
+//threads working on different lines along axis c of a chunk share the words that cross their lines, so these are written atomically
+void setGridChunkCrossingOccupancy(GridChunk *chunk_p, enum GridOccupancy occupancy, int cellIndex, bool occupied, int c){
 
-	//addEnemy(getVec2f(400.0, 100.0));
+	int x = cellIndex & (GRID_CHUNK_SIZE - 1);
+	int y = cellIndex >> GRID_CHUNK_SIZE_BITS;
 
-	staticParticlesGrid = (Pixel *)malloc(sizeof(Pixel) * GRID_WIDTH * GRID_HEIGHT);
-	drawingGrid = (Pixel *)malloc(sizeof(Pixel) * GRID_WIDTH * GRID_HEIGHT);
-	collisionIndexGrid = (int *)malloc(sizeof(int) * GRID_WIDTH * GRID_HEIGHT);
-	emptyCollisionIndexGrid = (int *)malloc(sizeof(int) * GRID_WIDTH * GRID_HEIGHT);
+	unsigned long long *crossingLine_p = c == 0 ? &chunk_p->occupancyColumns[occupancy][x] : &chunk_p->occupancyRows[occupancy][y];
+	unsigned long long crossingLineBit = 1ULL << (c == 0 ? y : x);
 
-	for(int i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++){
-		staticParticlesGrid[i] = BACKGROUND_COLOR;
-		emptyCollisionIndexGrid[i] = -1;
+	if(occupied){
+		__atomic_fetch_or(crossingLine_p, crossingLineBit, __ATOMIC_RELAXED);
+	}else{
+		__atomic_fetch_and(crossingLine_p, ~crossingLineBit, __ATOMIC_RELAXED);
 	}
 
-	//create world geometry
-	{
+}
 
-		paintArea(0, GRID_HEIGHT - 100, WIDTH, 100, ROCK_COLOR);
+//sets the solid and static occupancies of a cell from its material, the words of the line along axis c are only written by the thread working on that line
+//the crossing words are left alone when setCrossingLines is not set, they then have to be rebuilt from the lines along c later
+void setGridChunkStaticOccupancies(GridChunk *chunk_p, int cellIndex, enum Material material, int c, bool setCrossingLines){
 
-		/*
-		int posX = 0;
+	int x = cellIndex & (GRID_CHUNK_SIZE - 1);
+	int y = cellIndex >> GRID_CHUNK_SIZE_BITS;
 
-		posX += 300;
+	int line = c == 0 ? y : x;
+	unsigned long long lineBit = 1ULL << (c == 0 ? x : y);
 
-		paintArea(posX, GRID_HEIGHT - 125, 100, 25, ROCK_COLOR);
+	unsigned long long *solidLine_p = c == 0 ? &chunk_p->occupancyRows[GRID_OCCUPANCY_SOLID][line] : &chunk_p->occupancyColumns[GRID_OCCUPANCY_SOLID][line];
+	unsigned long long *staticLine_p = c == 0 ? &chunk_p->occupancyRows[GRID_OCCUPANCY_STATIC][line] : &chunk_p->occupancyColumns[GRID_OCCUPANCY_STATIC][line];
 
-		posX += 330;
+	bool isSolid = material == MATERIAL_ROCK || material == MATERIAL_STATIC_ROCK;
+	bool isStatic = material != MATERIAL_BACKGROUND;
 
-		paintArea(posX, GRID_HEIGHT - 200, 100, 100, ROCK_COLOR);
+	if(isSolid != ((*solidLine_p & lineBit) != 0)){
 
-		posX += 300;
+		__atomic_store_n(solidLine_p, *solidLine_p ^ lineBit, __ATOMIC_RELAXED);
+
+		if(setCrossingLines){
+			setGridChunkCrossingOccupancy(chunk_p, GRID_OCCUPANCY_SOLID, cellIndex, isSolid, c);
+		}
 
-		paintArea(posX, GRID_HEIGHT - 200, 100, 100, ROCK_COLOR);
+	}
 
-		posX += 200;
+	if(isStatic != ((*staticLine_p & lineBit) != 0)){
 
-		paintArea(0, HEIGHT - 100, posX, 100, ROCK_COLOR);
+		__atomic_store_n(staticLine_p, *staticLine_p ^ lineBit, __ATOMIC_RELAXED);
 
-		posX += 200;
+		if(setCrossingLines){
+			setGridChunkCrossingOccupancy(chunk_p, GRID_OCCUPANCY_STATIC, cellIndex, isStatic, c);
+		}
 
-		paintArea(posX, HEIGHT - 100, 300, 100, ROCK_COLOR);
+	}
 
-		posX += 300;
+}
 
-		paintArea(posX, HEIGHT - 200, 100, 200, STATIC_ROCK_COLOR);
+enum Material getStaticParticle(Vec2f pos){
 
-		posX += 100;
+	GridChunk *chunk_p = getGridChunk(pos);
 
-		paintArea(posX, HEIGHT - 100, 500, 100, STATIC_ROCK_COLOR);
-		*/
-	
+	if(chunk_p == NULL){
+		return MATERIAL_BACKGROUND;
 	}
 
-	cameraPos = getVec2f(0.0, 0.0);
-	cameraDest = getVec2f(0.0, 0.0);
+	return (enum Material)chunk_p->staticParticles[getGridChunkCellIndex(pos)];
 
 }
 
-void Engine_update(float deltaTime){
+//all writes to the static grid go through here so that only changed chunks are uploaded when drawing
+//c is the axis of the lines the calling thread has to itself, any axis will do outside of the collision passes
+//threadIndex is -1 outside of the static collision pass, inside it the crossing lines of the chunk are rebuilt once after the pass instead of written for every cell
+void setStaticParticle(Vec2f pos, enum Material material, int c, int threadIndex){
 
-	printf("---\n");
+	GridChunk *chunk_p = getGridChunk(pos);
+
+	if(chunk_p == NULL){
+
+		if(material == MATERIAL_BACKGROUND){
+			return;
+		}
+
+		chunk_p = getOrAddGridChunk(pos);
 
-	if(Engine_keys[ENGINE_KEY_Q].down){
-		Engine_quit();
 	}
 
-	//control bending
-	bendingPos = getVec2f(Engine_pointer.pos.x / ((float)Engine_clientWidth / (float)WIDTH) - cameraPos.x, Engine_pointer.pos.y / ((float)Engine_clientHeight / (float)HEIGHT) - cameraPos.y);
+	int cellIndex = getGridChunkCellIndex(pos);
 
-	if(Engine_pointer.down){
-		isBending = true;
-	}else{
-		isBending = false;
+	unsigned char *cell_p = &chunk_p->staticParticles[cellIndex];
+
+	//threads working on different lines of the same chunk can write to it at the same time
+	if(*cell_p == MATERIAL_BACKGROUND
+	&& material != MATERIAL_BACKGROUND){
+		__atomic_add_fetch(&chunk_p->numberOfStaticCells, 1, __ATOMIC_RELAXED);
+	}
+	if(*cell_p != MATERIAL_BACKGROUND
+	&& material == MATERIAL_BACKGROUND){
+		__atomic_sub_fetch(&chunk_p->numberOfStaticCells, 1, __ATOMIC_RELAXED);
 	}
 
-	if(Engine_pointer.downed){
+	setGridChunkStaticOccupancies(chunk_p, cellIndex, material, c, threadIndex == -1);
 
-		bool notOnlyRocks = false;
+	if(threadIndex != -1
+	&& !__atomic_load_n(&chunk_p->hasStaleCrossingOccupancies, __ATOMIC_RELAXED)
+	&& !__atomic_exchange_n(&chunk_p->hasStaleCrossingOccupancies, 1, __ATOMIC_RELAXED)){
+		staleCrossingOccupancyChunks[threadIndex].push_back(chunk_p);
+	}
 
-		for(int x = 0; x < BENDING_RADIUS * 2; x++){
-			for(int y = 0; y < BENDING_RADIUS * 2; y++){
+	*cell_p = material;
 
-				Vec2f pos = getVec2f(bendingPos.x - BENDING_RADIUS + x, bendingPos.y - BENDING_RADIUS + y);
-				int index = getGridIndex(pos);
+	__atomic_store_n(&chunk_p->dirty, 1, __ATOMIC_RELAXED);
 
-				if(getMagVec2f(getVec2f(x - BENDING_RADIUS, y - BENDING_RADIUS)) <= BENDING_RADIUS
-				&& !checkOub(pos)
-				&& staticParticlesGrid[index] == BACKGROUND_COLOR){
-					notOnlyRocks = true;
-				}
-			
-			}
-		}
+}
 
-		for(int x = 0; x < BENDING_RADIUS * 2; x++){
-			for(int y = 0; y < BENDING_RADIUS * 2; y++){
+//turns the 64 line words of a chunk along one axis into the 64 words of the lines crossing them, by swapping ever smaller blocks of bits
+void transposeGridChunkOccupancyLines(unsigned long long *crossingLines, unsigned long long *lines){
 
-				Vec2f pos = getVec2f(bendingPos.x - BENDING_RADIUS + x, bendingPos.y - BENDING_RADIUS + y);
-				int index = getGridIndex(pos);
+	memcpy(crossingLines, lines, sizeof(unsigned long long) * GRID_CHUNK_SIZE);
 
-				if(getMagVec2f(getVec2f(x - BENDING_RADIUS, y - BENDING_RADIUS)) <= BENDING_RADIUS
-				&& !checkOub(pos)
-				&& staticParticlesGrid[index] == ROCK_COLOR
-				&& notOnlyRocks){
+	unsigned long long mask = 0x00000000FFFFFFFFULL;
 
-					staticParticlesGrid[index] = BACKGROUND_COLOR;
+	for(int width = GRID_CHUNK_SIZE / 2; width > 0; width >>= 1, mask ^= mask << width){
+		for(int i = 0; i < GRID_CHUNK_SIZE; i = (i + width + 1) & ~width){
 
-					Particle particle;
-					Particle_init(&particle, pos);
+			unsigned long long swappedBits = ((crossingLines[i] >> width) ^ crossingLines[i + width]) & mask;
 
-					particles.push_back(particle);
+			crossingLines[i] ^= swappedBits << width;
+			crossingLines[i + width] ^= swappedBits;
 
-				}
-			
-			}
 		}
 	}
 
-	//handle entity physics
-	for(int i = 0; i < entities.size(); i++){
+}
 
-		Entity *entity_p = &entities[i];
+//rebuilds the static and solid words crossing axis c in the chunks the static collision pass wrote to, from the words of the lines along c
+void rebuildStaleCrossingOccupancies(int c){
 
-		entity_p->physics.acceleration = getVec2f(0.0, 0.0);
+	for(int i = 0; i < staleCrossingOccupancyChunks.size(); i++){
 
-		//control players
-		if(entity_p->type == ENTITY_TYPE_PLAYER){
+		std::vector<GridChunk *> *staleChunks_p = &staleCrossingOccupancyChunks[i];
 
-			if(Engine_keys[ENGINE_KEY_A].down){
-				entity_p->physics.acceleration.x += -PLAYER_WALK_SPEED;
-			}
-			if(Engine_keys[ENGINE_KEY_D].down){
-				entity_p->physics.acceleration.x += PLAYER_WALK_SPEED;
-			}
-			if(Engine_keys[ENGINE_KEY_W].down
-			&& entity_p->physics.onGround){
-				entity_p->physics.acceleration.y += -PLAYER_JUMP_SPEED;
-			}
+		for(int j = 0; j < staleChunks_p->size(); j++){
+
+			GridChunk *chunk_p = (*staleChunks_p)[j];
+
+			for(int k = 0; k < NUMBER_OF_GRID_OCCUPANCIES; k++){
+
+				if(k == GRID_OCCUPANCY_PARTICLE){
+					continue;
+				}
 
-			entity_p->physics.resistance.y = PLAYER_JUMP_RESISTANCE;
+				if(c == 0){
+					transposeGridChunkOccupancyLines(chunk_p->occupancyColumns[k], chunk_p->occupancyRows[k]);
+				}else{
+					transposeGridChunkOccupancyLines(chunk_p->occupancyRows[k], chunk_p->occupancyColumns[k]);
+				}
 
-			if(!Engine_keys[ENGINE_KEY_W].down
-			&& entity_p->physics.velocity.y < 0){
-				entity_p->physics.resistance.y = PLAYER_STOP_JUMP_RESISTANCE;
 			}
 
+			chunk_p->hasStaleCrossingOccupancies = 0;
+
 		}
 
-		//control enemies
-		if(entity_p->type == ENTITY_TYPE_ENEMY){
+		staleChunks_p->clear();
 
-			entity_p->enemyAI.clock++;
+	}
 
-			Vec2f playerPos;
-			for(int j = 0; j < entities.size(); j++){
-				if(entities[j].type == ENTITY_TYPE_PLAYER){
-					playerPos = getAddVec2f(entities[j].body.pos, getDivVec2fFloat(entities[j].body.size, 2.0));
-				}
-			}
+}
 
-			Vec2f enemyPos = getAddVec2f(entity_p->body.pos, getDivVec2fFloat(entity_p->body.size, 2.0));
+int getCollisionIndex(Vec2f pos){
 
-			bool aggro = false;
+	GridChunk *chunk_p = getGridChunk(pos);
 
-			entity_p->enemyAI.shouldJump = false;
+	if(chunk_p == NULL){
+		return -1;
+	}
 
-			if(getMagVec2f(getSubVec2f(playerPos, enemyPos)) <= ENEMY_DETECTION_RADIUS){
+	return chunk_p->collisionIndices[getGridChunkCellIndex(pos)];
 
-				aggro = true;
+}
 
-				entity_p->enemyAI.shouldJump = true;
-				
-			}
+//sets the particle occupancy of the cell in the line along axis c that it is on, the only line a search or body walk along c reads
+//particles are only moved along the lines of the thread that moves them, so the word of the line is never written by another thread
+void setGridChunkParticleOccupancy(GridChunk *chunk_p, int c, int cellIndex, bool occupied){
 
-			if(aggro){
+	int x = cellIndex & (GRID_CHUNK_SIZE - 1);
+	int y = cellIndex >> GRID_CHUNK_SIZE_BITS;
 
-				float direction = 1.0;
-				if(entity_p->body.pos.x + entity_p->body.size.x > playerPos.x){
-					direction = -1.0;
-				}
+	unsigned long long *word_p = c == 0 ? &chunk_p->occupancyRows[GRID_OCCUPANCY_PARTICLE][y] : &chunk_p->occupancyColumns[GRID_OCCUPANCY_PARTICLE][x];
+	unsigned long long bit = 1ULL << (c == 0 ? x : y);
 
-				entity_p->physics.acceleration.x += ENEMY_WALK_SPEED * direction;
+	if(occupied){
+		*word_p |= bit;
+	}else{
+		*word_p &= ~bit;
+	}
 
-				if(entity_p->enemyAI.shouldJump
-				&& entity_p->physics.onGround){
-					entity_p->physics.acceleration.y -= ENEMY_JUMP_SPEED;
-				}
+}
 
-				bool shouldShoot = false;
-				if(entity_p->enemyAI.clock % 30 == 0){
-					shouldShoot = true;
-				}
+//written cells are recorded per thread since the collision passes run on several threads
+void setCollisionIndex(Vec2f pos, int particleIndex, int c, int threadIndex){
 
-				if(shouldShoot){
+	GridChunk *chunk_p = getOrAddGridChunk(pos);
 
-					Vec2f velocity = getSubVec2f(playerPos, enemyPos);
-					Vec2f_normalize(&velocity);
-					Vec2f_mulByFloat(&velocity, BULLET_SPEED);
-					
-					addBullet(enemyPos, velocity);
+	int cellIndex = getGridChunkCellIndex(pos);
 
-				}
-			
-			}
+	int *cell_p = &chunk_p->collisionIndices[cellIndex];
 
-		}
+	*cell_p = particleIndex;
 
-		if(entity_p->type == ENTITY_TYPE_PLAYER
-		|| entity_p->type == ENTITY_TYPE_ENEMY){
-			entity_p->physics.acceleration.y += PLAYER_GRAVITY;
-		}
+	__atomic_store_n(&chunk_p->hasCollisionIndices, 1, __ATOMIC_RELAXED);
 
-		Vec2f_add(&entity_p->physics.velocity, entity_p->physics.acceleration);
-		Vec2f_mul(&entity_p->physics.velocity, entity_p->physics.resistance);
+	collisionIndexGridWrittenCells[threadIndex].push_back(cell_p);
 
-		entity_p->physics.onGround = false;
+	setGridChunkParticleOccupancy(chunk_p, c, cellIndex, true);
 
-		entity_p->lastBody = entity_p->body;
-	
+	if(!__atomic_load_n(&chunk_p->hasParticleOccupancy, __ATOMIC_RELAXED)
+	&& !__atomic_exchange_n(&chunk_p->hasParticleOccupancy, 1, __ATOMIC_RELAXED)){
+		particleOccupancyWrittenChunks[threadIndex].push_back(chunk_p);
 	}
 
-	//handle particle physics
-	for(int i = 0; i < particles.size(); i++){
+}
 
-		Particle *particle_p = &particles[i];
+//removes a particle from a cell without recording it, the cell must have been written with setCollisionIndex
+void resetCollisionIndex(Vec2f pos, int c){
 
-		particle_p->acceleration = getVec2f(0.0, 0.0);
+	GridChunk *chunk_p = getGridChunk(pos);
 
-		particle_p->acceleration.y += PARTICLE_GRAVITY;
+	int cellIndex = getGridChunkCellIndex(pos);
 
-		//bending force
-		if(isBending){
-			Vec2f force = getSubVec2f(bendingPos, particle_p->pos);
-			Vec2f_mulByFloat(&force, BENDING_FORCE);
-			Vec2f_add(&particle_p->acceleration, force);
-		}
+	chunk_p->collisionIndices[cellIndex] = -1;
 
-		Vec2f_add(&particle_p->velocity, particle_p->acceleration);
+	setGridChunkParticleOccupancy(chunk_p, c, cellIndex, false);
 
-		Vec2f_mul(&particle_p->velocity, particle_p->resistance);
+}
 
-		particle_p->lastPos = particle_p->pos;
+//resets only the cells written since the last clear, so the cost follows the number of particles and not the grid size
+void clearCollisionIndexGrid(){
 
-	}
+	for(int i = 0; i < collisionIndexGridWrittenCells.size(); i++){
 
-	//move and collide things
-	for(int c = 0; c < 2; c++){
+		std::vector<int *> *writtenCells_p = &collisionIndexGridWrittenCells[i];
 
-		//move entities
-		for(int i = 0; i < entities.size(); i++){
+		for(int j = 0; j < writtenCells_p->size(); j++){
+			*(*writtenCells_p)[j] = -1;
+		}
 
-			Entity *entity_p = &entities[i];
+		writtenCells_p->clear();
 
-			entity_p->body.pos[c] += entity_p->physics.velocity[c];
-		
+	}
+
+	for(int i = 0; i < particleOccupancyWrittenChunks.size(); i++){
+
+		std::vector<GridChunk *> *writtenChunks_p = &particleOccupancyWrittenChunks[i];
+
+		for(int j = 0; j < writtenChunks_p->size(); j++){
+			memset((*writtenChunks_p)[j]->occupancyRows[GRID_OCCUPANCY_PARTICLE], 0, sizeof(unsigned long long) * GRID_CHUNK_SIZE);
+			memset((*writtenChunks_p)[j]->occupancyColumns[GRID_OCCUPANCY_PARTICLE], 0, sizeof(unsigned long long) * GRID_CHUNK_SIZE);
+			(*writtenChunks_p)[j]->hasParticleOccupancy = 0;
 		}
 
-		std::vector<int> removedParticleIDs;
+		writtenChunks_p->clear();
 
-		//move particles
-		for(int i = 0; i < particles.size(); i++){
+	}
 
-			Particle *particle_p = &particles[i];
+}
 
-			particle_p->pos[c] += particle_p->velocity[c];
+//bit i is set if the cell start + i of the line is occupied, where the line is row line for axis 0 and column line for axis 1
+//cells that are oub are never occupied, the width can be at most 64
+unsigned long long getGridOccupancyLineMask(int c, int line, int start, int width, enum GridOccupancy occupancy){
 
-		}
+	int length = c == 0 ? GRID_WIDTH : GRID_HEIGHT;
+	int numberOfLines = c == 0 ? GRID_HEIGHT : GRID_WIDTH;
 
-		//handle static particle collisions
-		for(int i = 0; i < particles.size(); i++){
+	if(line < 0
+	|| line >= numberOfLines){
+		return 0;
+	}
 
-			Particle *particle_p = &particles[i];
+	unsigned long long mask = 0;
+	int bit = 0;
 
-			if(checkOub(particle_p->pos)){
-				continue;
-			}
+	if(start < 0){
+		bit = -start;
+		width += start;
+		start = 0;
+	}
+
+	if(start + width > length){
+		width = length - start;
+	}
 
-			int index = getGridIndex(particle_p->pos);
+	//a line of 64 cells spans at most two chunks
+	while(width > 0){
 
-			if(staticParticlesGrid[index] == ROCK_COLOR){
+		int cell = start & (GRID_CHUNK_SIZE - 1);
+		int numberOfCells = GRID_CHUNK_SIZE - cell;
+		if(numberOfCells > width){
+			numberOfCells = width;
+		}
 
-				Vec2f pos = particle_p->pos;
-				bool foundEmptySpot = false;
-				int steps = 0;
+		int chunkIndex = c == 0
+			? GRID_CHUNKS_WIDTH * (line >> GRID_CHUNK_SIZE_BITS) + (start >> GRID_CHUNK_SIZE_BITS)
+			: GRID_CHUNKS_WIDTH * (start >> GRID_CHUNK_SIZE_BITS) + (line >> GRID_CHUNK_SIZE_BITS);
 
-				while(!checkOub(pos)){
+		GridChunk *chunk_p = __atomic_load_n(&gridChunks[chunkIndex], __ATOMIC_ACQUIRE);
 
-					steps++;
+		if(chunk_p != NULL){
 
-					{
-						Vec2f newPos = pos;
-						newPos[c] += steps;
+			unsigned long long *words = c == 0 ? chunk_p->occupancyRows[occupancy] : chunk_p->occupancyColumns[occupancy];
 
-						int newIndex = getGridIndex(newPos);
+			unsigned long long cells = __atomic_load_n(&words[line & (GRID_CHUNK_SIZE - 1)], __ATOMIC_RELAXED) >> cell;
 
-						if(!checkOub(newPos)
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							foundEmptySpot = true;
-							pos = newPos;
-							break;
-						}
-					}
-					{
-						Vec2f newPos = pos;
-						newPos[c] -= steps;
+			if(numberOfCells < 64){
+				cells &= (1ULL << numberOfCells) - 1;
+			}
 
-						int newIndex = getGridIndex(newPos);
+			mask |= cells << bit;
 
-						if(!checkOub(newPos)
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							foundEmptySpot = true;
-							pos = newPos;
-							break;
-						}
-					}
+		}
 
-				}
+		bit += numberOfCells;
+		start += numberOfCells;
+		width -= numberOfCells;
 
-				if(foundEmptySpot){
+	}
 
-					bool particleIsBended = false;
+	return mask;
 
-					if(isBending
-					&& getMagVec2f(getSubVec2f(particle_p->pos, bendingPos)) <= BENDING_RADIUS){
-						particleIsBended = true;
-					}
+}
 
-					if(particleIsBended){
-						particle_p->pos = pos;
-						particle_p->velocity[c] = 0.0;
-					}else{
-						int newIndex = getGridIndex(pos);
+//finds the first occupied cell of a body in the order the cells are walked, x then y, starting at and including cell (x, y) of the body
+//the occupancy is read from the lines along axis c, bodies can be at most 64 cells wide and high
+bool findOccupiedBodyCell(Body body, int c, enum GridOccupancy occupancy, int *x_p, int *y_p){
 
-						staticParticlesGrid[newIndex] = ROCK_COLOR;
+	int gridX = (int)floorf(body.pos.x);
+	int gridY = (int)floorf(body.pos.y);
+	int width = (int)ceilf(body.size.x);
+	int height = (int)ceilf(body.size.y);
 
-						particles.erase(particles.begin() + i, particles.begin() + i + 1);
-					}
+	int startX = *x_p;
 
-					i = -1;
-					continue;
+	if(startX >= width){
+		return false;
+	}
 
-				}else{
+	//a column of the body is one line along y, so the walk can go a column at a time
+	if(c == 1){
 
-					particles.erase(particles.begin() + i, particles.begin() + i + 1);
-					i--;
-					continue;
-				}
-			}
-			
-		}
+		for(int x = startX; x < width; x++){
 
-		//put particles into collision index grid
-		memcpy(collisionIndexGrid, emptyCollisionIndexGrid, sizeof(int) * GRID_WIDTH * GRID_HEIGHT);
+			unsigned long long cells = getGridOccupancyLineMask(1, gridX + x, gridY, height, occupancy);
 
-		for(int i = 0; i < particles.size(); i++){
+			if(x == startX){
+				cells = *y_p < 64 ? cells & ~((1ULL << *y_p) - 1) : 0;
+			}
 
-			if(checkOub(particles[i].pos)){
-				continue;
+			if(cells != 0){
+				*x_p = x;
+				*y_p = __builtin_ctzll(cells);
+				return true;
 			}
 
-			int index = getGridIndex(particles[i].pos);
-			
-			collisionIndexGrid[index] = i;
-		
 		}
 
-		//handle moving particle and static rock collisions
-		for(int i = 0; i < particles.size(); i++){
+		return false;
 
-			Particle *particle_p = &particles[i];
+	}
 
-			if(checkOub(particle_p->pos)){
-				continue;
-			}
+	//bit 0 of each row is the column the walk is in
+	unsigned long long rows[64];
+	unsigned long long columns = 0;
 
-			int index = getGridIndex(particle_p->pos);
+	for(int y = 0; y < height; y++){
 
-			if((collisionIndexGrid[index] != -1
-			&& collisionIndexGrid[index] != i)
-			|| staticParticlesGrid[index] == STATIC_ROCK_COLOR){
+		rows[y] = getGridOccupancyLineMask(0, gridY + y, gridX + startX, width - startX, occupancy);
 
-				Vec2f pos = particle_p->pos;
-				bool foundEmptyCell = false;
-				int steps = 0;
+		if(y < *y_p){
+			rows[y] &= ~1ULL;
+		}
 
-				while(!checkOub(pos)){
-					
-					steps++;
+		columns |= rows[y];
 
-					{
-						Vec2f newPos = pos;
-						newPos[c] += steps;
+	}
 
-						int newIndex = getGridIndex(newPos);
+	if(columns == 0){
+		return false;
+	}
 
-						if(collisionIndexGrid[newIndex] == -1
-						&& collisionIndexGrid[newIndex] != i
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							pos = newPos;
-							foundEmptyCell = true;
-							break;
-						}
-					
-					}
-					{
-						Vec2f newPos = pos;
-						newPos[c] -= steps;
-
-						int newIndex = getGridIndex(newPos);
-
-						if(collisionIndexGrid[newIndex] == -1
-						&& collisionIndexGrid[newIndex] != i
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							pos = newPos;
-							foundEmptyCell = true;
-							break;
-						}
-					
-					}
+	//the first column with an occupied cell is the one the walk reaches first
+	int column = __builtin_ctzll(columns);
 
-				}
+	for(int y = 0; y < height; y++){
+		if((rows[y] >> column) & 1){
+			*x_p = startX + column;
+			*y_p = y;
+			return true;
+		}
+	}
 
-				if(foundEmptyCell){
+	return false;
 
-					particle_p->pos = pos;
+}
 
-					particle_p->velocity[c] *= PARTICLE_COLLISION_DAMPENING;
+//probes is how many cells a search one cell at a time would have tried, worked out from the distance to the cell that was found and not counted while searching
+//lineReads is how many occupancy words of up to 64 cells were read, directChecks how many single cells were read from the grid before reading any words, all reported per update
+//every thread counts its own searches, padded to a cache line so that threads do not write to the same one
+typedef struct FreeCellSearchStats{
+	long long probes;
+	long long lineReads;
+	long long directChecks;
+	char padding[40];
+}FreeCellSearchStats;
 
-					int newIndex = getGridIndex(pos);
+std::vector<FreeCellSearchStats> freeCellSearchStats;
 
-					collisionIndexGrid[newIndex] = i;
+//bit i is set if the cell start + i of the line is free of all the occupancies and not between excludedStart and excludedEnd
+unsigned long long getFreeCellMask(int c, int line, int start, int width, unsigned int occupancies, int excludedStart, int excludedEnd, long long *lineReads_p){
 
-				}else{
-					removedParticleIDs.push_back(particle_p->ID);
-				}
+	unsigned long long occupied = 0;
 
-			}
+	for(int i = 0; i < NUMBER_OF_GRID_OCCUPANCIES; i++){
+		if(occupancies & (1 << i)){
+			occupied |= getGridOccupancyLineMask(c, line, start, width, (enum GridOccupancy)i);
+			(*lineReads_p)++;
+		}
+	}
 
+	unsigned long long mask = ~occupied;
+
+	if(width < 64){
+		mask &= (1ULL << width) - 1;
+	}
+
+	for(int i = excludedStart; i <= excludedEnd; i++){
+		if(i >= start
+		&& i < start + width){
+			mask &= ~(1ULL << (i - start));
 		}
+	}
 
-		//handle particles oub
-		for(int i = 0; i < particles.size(); i++){
+	return mask;
 
-			Particle *particle_p = &particles[i];
+}
 
-			if(checkOub(particle_p->pos)){
+//finds the closest cell to pos along axis c that is in the grid and free of all the occupancies, trying +1, -1, +2, -2 and so on up to maxSteps like a search one cell at a time would
+//the cells from excludedStart to excludedEnd along the axis are skipped, returns the signed number of steps to the cell or 0 if there is none
+int findNearestFreeCell(Vec2f pos, int c, int maxSteps, unsigned int occupancies, int excludedStart, int excludedEnd, int threadIndex){
 
-				Vec2f pos = particle_p->pos;
-				bool foundEmptyCell = false;
-				int steps = 0;
+	int length = c == 0 ? GRID_WIDTH : GRID_HEIGHT;
+	int numberOfLines = c == 0 ? GRID_HEIGHT : GRID_WIDTH;
 
-				for(int j = 0; j < GRID_WIDTH; j++){
-					
-					steps++;
+	int cell = (int)floorf(pos[c]);
+	int line = (int)floorf(pos[1 - c]);
 
-					{
-						Vec2f newPos = pos;
-						newPos[c] += steps;
+	long long lineReads = 0;
+	int steps = 0;
 
-						int newIndex = getGridIndex(newPos);
+	//most searches end next to the cell, so the cells up to 31 steps away on both sides are read first as one line of 64 around it
+	int windowSteps = maxSteps < 31 ? maxSteps : 31;
 
-						if(!checkOub(newPos)
-						&& collisionIndexGrid[newIndex] == -1
-						&& collisionIndexGrid[newIndex] != i
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							pos = newPos;
-							foundEmptyCell = true;
-							break;
-						}
-					
-					}
-					{
-						Vec2f newPos = pos;
-						newPos[c] -= steps;
-
-						int newIndex = getGridIndex(newPos);
-
-						if(!checkOub(newPos)
-						&& collisionIndexGrid[newIndex] == -1
-						&& collisionIndexGrid[newIndex] != i
-						&& staticParticlesGrid[newIndex] == BACKGROUND_COLOR){
-							pos = newPos;
-							foundEmptyCell = true;
-							break;
-						}
-					
-					}
+	if(line >= 0
+	&& line < numberOfLines){
 
-				}
+		int windowStart = cell - windowSteps > 0 ? cell - windowSteps : 0;
+		int windowEnd = cell + windowSteps < length - 1 ? cell + windowSteps : length - 1;
 
-				if(foundEmptyCell){
+		if(windowStart <= windowEnd){
 
-					particle_p->pos = pos;
+			unsigned long long freeCells = getFreeCellMask(c, line, windowStart, windowEnd - windowStart + 1, occupancies, excludedStart, excludedEnd, &lineReads);
 
-					particle_p->velocity[c] *= PARTICLE_COLLISION_DAMPENING;
+			//the cell itself can be oub and outside the window when a particle is moved back in
+			int bit = cell - windowStart;
 
-					int newIndex = getGridIndex(pos);
+			unsigned long long rightCells = bit < 0 ? freeCells : bit < 63 ? freeCells & ~((2ULL << bit) - 1) : 0;
+			unsigned long long leftCells = bit <= 0 ? 0 : bit < 64 ? freeCells & ((1ULL << bit) - 1) : freeCells;
 
-					collisionIndexGrid[newIndex] = i;
+			int rightSteps = 0;
+			int leftSteps = 0;
 
-				}else{
-					removedParticleIDs.push_back(particle_p->ID);
-				}
+			if(rightCells != 0){
+				rightSteps = windowStart + __builtin_ctzll(rightCells) - cell;
+			}
 
+			if(leftCells != 0){
+				leftSteps = cell - (windowStart + 63 - __builtin_clzll(leftCells));
+			}
+
+			//at the same distance the step forward is tried first
+			if(rightSteps > 0
+			&& (leftSteps == 0 || rightSteps <= leftSteps)){
+				steps = rightSteps;
+			}else if(leftSteps > 0){
+				steps = -leftSteps;
 			}
 
 		}
 
-		//handle entity particle collisions for players and enemies
-		for(int i = 0; i < entities.size(); i++){
+	}
+
+	//further away the cells on both sides are read 64 at a time at the same distance, so the first side with a free cell has the closest one, or both do
+	if(line >= 0
+	&& line < numberOfLines){
+		for(int distance = windowSteps + 1; distance <= maxSteps && steps == 0; distance += 64){
+
+			int width = maxSteps - distance + 1 < 64 ? maxSteps - distance + 1 : 64;
+
+			int rightSteps = 0;
+			int leftSteps = 0;
+
+			//cells oub are cut away here, since they are never occupied
+			int rightStart = cell + distance;
+			int rightEnd = rightStart + width - 1 < length - 1 ? rightStart + width - 1 : length - 1;
+			if(rightStart < 0){
+				rightStart = 0;
+			}
+
+			if(rightStart <= rightEnd){
+
+				unsigned long long freeCells = getFreeCellMask(c, line, rightStart, rightEnd - rightStart + 1, occupancies, excludedStart, excludedEnd, &lineReads);
+
+				if(freeCells != 0){
+					rightSteps = rightStart + __builtin_ctzll(freeCells) - cell;
+				}
+
+			}
+
+			int leftEnd = cell - distance;
+			int leftStart = leftEnd - width + 1 > 0 ? leftEnd - width + 1 : 0;
+			if(leftEnd > length - 1){
+				leftEnd = length - 1;
+			}
+
+			if(leftStart <= leftEnd){
+
+				unsigned long long freeCells = getFreeCellMask(c, line, leftStart, leftEnd - leftStart + 1, occupancies, excludedStart, excludedEnd, &lineReads);
+
+				if(freeCells != 0){
+					leftSteps = cell - (leftStart + 63 - __builtin_clzll(freeCells));
+				}
+
+			}
+
+			//at the same distance the step forward is tried first
+			if(rightSteps > 0
+			&& (leftSteps == 0 || rightSteps <= leftSteps)){
+				steps = rightSteps;
+			}else if(leftSteps > 0){
+				steps = -leftSteps;
+			}
+
+		}
+	}
+
+	long long probes = 2 * (long long)maxSteps;
+
+	if(steps > 0){
+		probes = 2 * steps - 1;
+	}
+	if(steps < 0){
+		probes = -2 * steps;
+	}
+
+	freeCellSearchStats[threadIndex].probes += probes;
+	freeCellSearchStats[threadIndex].lineReads += lineReads;
+
+	return steps;
+
+}
+
+void Body_init(Body *body_p, Vec2f pos, Vec2f size){
+	body_p->pos = pos;
+	body_p->size = size;
+}
+
+bool checkBodyVec2fCol(Body body, Vec2f v){
+	return v.x >= body.pos.x
+		&& v.x < body.pos.x + body.size.x
+		&& v.y >= body.pos.y
+		&& v.y < body.pos.y + body.size.y;
+}
+
+void Physics_init(Physics *physics_p){
+	physics_p->velocity = getVec2f(0.0, 0.0);
+	physics_p->acceleration = getVec2f(0.0, 0.0);
+	physics_p->resistance = getVec2f(1.0, 1.0);
+}
+
+void addParticle(Vec2f pos){
+
+	Particles_add(&particles, currentParticleID, pos);
+
+	currentParticleID++;
+
+}
+
+void Entity_init(Entity *entity_p, Vec2f pos, Vec2f size, enum EntityType type){
+
+	//also clears the padding, so that snapshots of the same entities are the same bytes
+	memset(entity_p, 0, sizeof(Entity));
+
+	Body_init(&entity_p->body, pos, size);
+	Physics_init(&entity_p->physics);
+
+	entity_p->lastBody = entity_p->body;
+
+	entity_p->type = type;
+
+}
+
+void addPlayer(Vec2f pos){
+
+	Entity entity;
+
+	Entity_init(&entity, pos, getVec2f(15.0, 20.0), ENTITY_TYPE_PLAYER);
+	entity.physics.resistance.x = PLAYER_WALK_RESISTANCE;
+
+	entities.push_back(entity);
+
+}
+
+void addEnemy(Vec2f pos){
+
+	Entity entity;
+
+	Entity_init(&entity, pos, getVec2f(15.0, 20.0), ENTITY_TYPE_ENEMY);
+
+	entity.physics.resistance.x = ENEMY_WALK_RESISTANCE;
+
+	entities.push_back(entity);
+
+}
+
+void addBullet(Vec2f pos, Vec2f velocity){
+
+	Entity entity;
+
+	Entity_init(&entity, pos, getVec2f(10.0, 10.0), ENTITY_TYPE_BULLET);
+
+	entity.physics.velocity = velocity;
+
+	entities.push_back(entity);
+
+
+}
+
+//targetEntityIndices maps the items of targetSpatialHash to indices into entities, which are valid until entities are removed
+void updateTargetSpatialHash(){
+
+	SpatialHash_clear(&targetSpatialHash);
+	targetEntityIndices.clear();
+
+	for(int i = 0; i < entities.size(); i++){
+		if(entities[i].type == ENTITY_TYPE_PLAYER){
+			SpatialHash_add(&targetSpatialHash, entities[i].body.pos, entities[i].body.size);
+			targetEntityIndices.push_back(i);
+		}
+	}
+
+	SpatialHash_build(&targetSpatialHash);
+
+}
+
+//appends the indices of the players whose bodies overlap the circle
+void getTargetsInRadius(Vec2f center, float radius, std::vector<int> *entityIndices_p){
+
+	targetQueryResults.clear();
+	SpatialHash_queryRadius(&targetSpatialHash, center, radius, &targetQueryResults);
+
+	for(int i = 0; i < targetQueryResults.size(); i++){
+		entityIndices_p->push_back(targetEntityIndices[targetQueryResults[i]]);
+	}
+
+}
+
+//appends the indices of the players whose bodies overlap the box
+void getTargetsInBox(Vec2f pos, Vec2f size, std::vector<int> *entityIndices_p){
+
+	targetQueryResults.clear();
+	SpatialHash_queryBox(&targetSpatialHash, pos, size, &targetQueryResults);
+
+	for(int i = 0; i < targetQueryResults.size(); i++){
+		entityIndices_p->push_back(targetEntityIndices[targetQueryResults[i]]);
+	}
+
+}
+
+//keeps the order of the entities that are left, so the player stays first
+void removeMarkedEntities(){
+
+	int numberOfEntities = 0;
+
+	for(int i = 0; i < entities.size(); i++){
+		if(!removedEntities[i]){
+			entities[numberOfEntities] = entities[i];
+			numberOfEntities++;
+		}
+	}
+
+	entities.resize(numberOfEntities);
+
+}
+
+void paintArea(int inputX, int inputY, int w, int h, enum Material material){
+	for(int x = 0; x < w; x++){
+		for(int y = 0; y < h; y++){
+
+			Vec2f pos = getVec2f(inputX + x, inputY + y);
+
+			if(!checkOub(pos)){
+				setStaticParticle(pos, material, 0, -1);
+			}
+
+		}
+	}
+}
+
+//PARTICLE COLLISION PASSES
+
+/*
+During the pass for axis c a particle only looks at and writes cells on its own line, which is its row when c is 0 and its column when c is 1.
+Lines are therefore handled in parallel, while the particles on one line are handled in index order by a single thread.
+This gives the same result as handling all particles in index order, for any number of threads.
+*/
+
+void handleStaticParticleCollision(int i, int c, int threadIndex){
+
+	Vec2f particlePos = Particles_getPos(&particles, i);
+
+	if(checkOub(particlePos)){
+		return;
+	}
+
+
+	if(getStaticParticle(particlePos) == MATERIAL_ROCK){
+
+		Vec2f pos = particlePos;
+
+		//nearly all rock particles settle right next to where they hit, so the two cells there are checked directly before any line words are read
+		int steps = 0;
+
+		int cell = (int)floorf(pos[c]);
+		int line = (int)floorf(pos[1 - c]);
+		int length = c == 0 ? GRID_WIDTH : GRID_HEIGHT;
+
+		for(int step = 1; step >= -1; step -= 2){
+
+			if(cell + step < 0
+			|| cell + step >= length){
+				continue;
+			}
+
+			freeCellSearchStats[threadIndex].directChecks++;
+
+			Vec2f newPos;
+			newPos[c] = cell + step;
+			newPos[1 - c] = line;
+
+			GridChunk *chunk_p = getGridChunk(newPos);
+
+			if(chunk_p == NULL
+			|| chunk_p->staticParticles[getGridChunkCellIndex(newPos)] == MATERIAL_BACKGROUND){
+				steps = step;
+				break;
+			}
+
+		}
+
+		if(steps != 0){
+			freeCellSearchStats[threadIndex].probes += steps == 1 ? 1 : 2;
+		}else{
+			steps = findNearestFreeCell(pos, c, GRID_WIDTH, 1 << GRID_OCCUPANCY_STATIC, 0, -1, threadIndex);
+		}
+
+		pos[c] += steps;
+
+		if(steps != 0){
+
+			bool particleIsBended = false;
+
+			if(isBending
+			&& getMagVec2f(getSubVec2f(particlePos, bendingPos)) <= BENDING_RADIUS){
+				particleIsBended = true;
+			}
+
+			if(particleIsBended){
+				Particles_setPos(&particles, i, pos);
+				particles.velocity[c][i] = 0.0;
+			}else{
+				setStaticParticle(pos, MATERIAL_ROCK, c, threadIndex);
+
+				removedParticles[i] = 1;
+			}
+
+		}else{
+			removedParticles[i] = 1;
+		}
+	}
+
+}
+
+void handleMovingParticleCollision(int i, int c, int threadIndex){
+
+	Vec2f particlePos = Particles_getPos(&particles, i);
+
+	if(checkOub(particlePos)){
+		return;
+	}
+
+
+	int collisionIndex = getCollisionIndex(particlePos);
+
+	if((collisionIndex != -1
+	&& collisionIndex != i)
+	|| getStaticParticle(particlePos) == MATERIAL_STATIC_ROCK){
+
+		Vec2f pos = particlePos;
+
+		int steps = findNearestFreeCell(pos, c, GRID_WIDTH, (1 << GRID_OCCUPANCY_STATIC) | (1 << GRID_OCCUPANCY_PARTICLE), 0, -1, threadIndex);
+
+		pos[c] += steps;
+
+		if(steps != 0){
+
+			Particles_setPos(&particles, i, pos);
+
+			particles.velocity[c][i] *= PARTICLE_COLLISION_DAMPENING;
+
+
+			setCollisionIndex(pos, i, c, threadIndex);
+
+		}else{
+			removedParticles[i] = 1;
+		}
+
+	}
+
+}
+
+void handleParticleOub(int i, int c, int threadIndex){
+
+	Vec2f particlePos = Particles_getPos(&particles, i);
+
+	if(checkOub(particlePos)){
+
+		Vec2f pos = particlePos;
+
+		int steps = findNearestFreeCell(pos, c, GRID_WIDTH, (1 << GRID_OCCUPANCY_STATIC) | (1 << GRID_OCCUPANCY_PARTICLE), 0, -1, threadIndex);
+
+		pos[c] += steps;
+
+		if(steps != 0){
+
+			Particles_setPos(&particles, i, pos);
+
+			particles.velocity[c][i] *= PARTICLE_COLLISION_DAMPENING;
+
+
+			setCollisionIndex(pos, i, c, threadIndex);
+
+		}else{
+			removedParticles[i] = 1;
+		}
+
+	}
+
+}
+
+//sorts the particle indices by the line they are on for axis c, keeping index order within each line
+void updateParticleLines(int c){
+
+	int numberOfLines = c == 0 ? GRID_HEIGHT : GRID_WIDTH;
+
+	//with a single thread all particles form one line in index order, which skips the sorting and gives the same result
+	if(JobSystem_getNumberOfThreads() == 1){
+
+		particleLines.starts.assign(2, 0);
+		particleLines.starts[1] = particles.length;
+		particleLines.oubParticleIndices.clear();
+
+		particleLines.particleIndices.resize(particles.length);
+		for(int i = 0; i < particles.length; i++){
+			particleLines.particleIndices[i] = i;
+		}
+
+		return;
+
+	}
+
+	std::vector<int> *particleLine_p = &particleLines.particleLine;
+
+	particleLines.starts.assign(numberOfLines + 1, 0);
+	particleLines.particleIndices.resize(particles.length);
+	particleLine_p->resize(particles.length);
+	particleLines.oubParticleIndices.clear();
+
+	for(int i = 0; i < particles.length; i++){
+
+		float linePos = particles.pos[1 - c][i];
+
+		if(linePos < 0
+		|| linePos >= numberOfLines){
+			(*particleLine_p)[i] = -1;
+			particleLines.oubParticleIndices.push_back(i);
+			continue;
+		}
+
+		(*particleLine_p)[i] = (int)linePos;
+		particleLines.starts[(*particleLine_p)[i] + 1]++;
+
+	}
+
+	for(int i = 0; i < numberOfLines; i++){
+		particleLines.starts[i + 1] += particleLines.starts[i];
+	}
+
+	particleLines.ends.assign(particleLines.starts.begin(), particleLines.starts.end() - 1);
+
+	for(int i = 0; i < particles.length; i++){
+		int line = (*particleLine_p)[i];
+		if(line != -1){
+			particleLines.particleIndices[particleLines.ends[line]] = i;
+			particleLines.ends[line]++;
+		}
+	}
+
+}
+
+void moveParticlesJob(void *data, int start, int end, int threadIndex){
+
+	PROFILER_ZONE("moveParticlesJob");
+
+	int c = *(int *)data;
+
+	for(int i = start; i < end; i++){
+		particles.pos[c][i] += particles.velocity[c][i];
+	}
+
+}
+
+void handleStaticParticleCollisionsJob(void *data, int start, int end, int threadIndex){
+
+	PROFILER_ZONE("handleStaticParticleCollisionsJob");
+
+	int c = *(int *)data;
+
+	for(int line = start; line < end; line++){
+		for(int j = particleLines.starts[line]; j < particleLines.starts[line + 1]; j++){
+			handleStaticParticleCollision(particleLines.particleIndices[j], c, threadIndex);
+		}
+	}
+
+}
+
+void handleMovingParticleCollisionsJob(void *data, int start, int end, int threadIndex){
+
+	PROFILER_ZONE("handleMovingParticleCollisionsJob");
+
+	int c = *(int *)data;
+
+	for(int line = start; line < end; line++){
+
+		int lineStart = particleLines.starts[line];
+		int lineEnd = particleLines.starts[line + 1];
+
+		for(int j = lineStart; j < lineEnd; j++){
+
+			int i = particleLines.particleIndices[j];
+
+			Vec2f particlePos = Particles_getPos(&particles, i);
+
+			if(!checkOub(particlePos)){
+				setCollisionIndex(particlePos, i, c, threadIndex);
+			}
+
+		}
+
+		for(int j = lineStart; j < lineEnd; j++){
+			handleMovingParticleCollision(particleLines.particleIndices[j], c, threadIndex);
+		}
+
+		for(int j = lineStart; j < lineEnd; j++){
+			handleParticleOub(particleLines.particleIndices[j], c, threadIndex);
+		}
+
+	}
+
+}
+
+void Engine_start(){
+
+	printf("Starting the engine\n");
+
+	Engine_setWindowSize(WIDTH * 2, HEIGHT * 2);
+
+	Engine_centerWindow();
+
+	if(!Engine_isHeadless){
+
+		Renderer2D_init(&renderer, WIDTH, HEIGHT);
+
+		Renderer2D_Font_init(&hudFont, "assets/fonts/times.ttf", 12);
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	}
+
+	//init world
+	SpatialHash_init(&targetSpatialHash, TARGET_SPATIAL_HASH_CELL_SIZE, TARGET_SPATIAL_HASH_BUCKETS);
+
+	addPlayer(getVec2f(100.0, GRID_HEIGHT - 200.0));
+
+	Particles_init(&particles);
+
+	//addEnemy(getVec2f(400.0, 100.0));
+
+	collisionIndexGridWrittenCells.resize(JobSystem_getNumberOfThreads());
+	particleOccupancyWrittenChunks.resize(JobSystem_getNumberOfThreads());
+	staleCrossingOccupancyChunks.resize(JobSystem_getNumberOfThreads());
+	freeCellSearchStats.resize(JobSystem_getNumberOfThreads());
+
+	//create world geometry
+	{
+
+		paintArea(0, GRID_HEIGHT - 100, WIDTH, 100, MATERIAL_ROCK);
+
+		/*
+		int posX = 0;
+
+		posX += 300;
+
+		paintArea(posX, GRID_HEIGHT - 125, 100, 25, MATERIAL_ROCK);
+
+		posX += 330;
+
+		paintArea(posX, GRID_HEIGHT - 200, 100, 100, MATERIAL_ROCK);
+
+		posX += 300;
+
+		paintArea(posX, GRID_HEIGHT - 200, 100, 100, MATERIAL_ROCK);
+
+		posX += 200;
+
+		paintArea(0, HEIGHT - 100, posX, 100, MATERIAL_ROCK);
+
+		posX += 200;
+
+		paintArea(posX, HEIGHT - 100, 300, 100, MATERIAL_ROCK);
+
+		posX += 300;
+
+		paintArea(posX, HEIGHT - 200, 100, 200, MATERIAL_STATIC_ROCK);
+
+		posX += 100;
+
+		paintArea(posX, HEIGHT - 100, 500, 100, MATERIAL_STATIC_ROCK);
+		*/
+	
+	}
+
+#ifdef BENCH_PARTICLES
+	//stack particles on a ground spanning the whole grid, row by row upwards
+	paintArea(0, GRID_HEIGHT - 100, GRID_WIDTH, 100, MATERIAL_ROCK);
+
+	for(int i = 0; i < BENCH_PARTICLES && i < GRID_WIDTH * (GRID_HEIGHT - 100); i++){
+
+		addParticle(getVec2f(i % GRID_WIDTH, GRID_HEIGHT - 101 - i / GRID_WIDTH));
+
+	}
+#endif
+
+#ifdef BENCH_ENEMIES
+	//enemies spread over the whole grid, the ones close enough to the player shoot at it
+	paintArea(0, GRID_HEIGHT - 100, GRID_WIDTH, 100, MATERIAL_ROCK);
+
+	for(int i = 0; i < BENCH_ENEMIES; i++){
+		addEnemy(getVec2f((float)i * (GRID_WIDTH - 15) / BENCH_ENEMIES, GRID_HEIGHT - 150.0 - i % 4 * 25));
+	}
+#endif
+
+	cameraPos = getVec2f(0.0, 0.0);
+	lastCameraPos = cameraPos;
+	cameraDest = getVec2f(0.0, 0.0);
+
+}
+
+void Engine_update(float deltaTime){
+
+	long long updateStartTime = Engine_getTimeNanoseconds();
+
+	if(Engine_keys[ENGINE_KEY_H].downed){
+		showHud = !showHud;
+	}
+
+	if(Engine_keys[ENGINE_KEY_Q].down){
+		Engine_quit();
+	}
+
+	if(Engine_keys[ENGINE_KEY_P].downed){
+		Profiler_printReport();
+		Profiler_writeChromeTrace("trace.json");
+	}
+
+	if(Engine_keys[ENGINE_KEY_K].downed){
+		Engine_saveSnapshot("world.snapshot");
+	}
+
+	if(Engine_keys[ENGINE_KEY_L].downed){
+		Engine_loadSnapshot("world.snapshot");
+	}
+
+	//control bending
+	{
+		PROFILER_ZONE("bending");
+
+		bendingPos = getVec2f(Engine_pointer.pos.x / ((float)Engine_clientWidth / (float)WIDTH) - cameraPos.x, Engine_pointer.pos.y / ((float)Engine_clientHeight / (float)HEIGHT) - cameraPos.y);
+
+		if(Engine_pointer.down){
+			isBending = true;
+		}else{
+			isBending = false;
+		}
+
+		if(Engine_pointer.downed){
+
+			bool notOnlyRocks = false;
+
+			for(int x = 0; x < BENDING_RADIUS * 2; x++){
+				for(int y = 0; y < BENDING_RADIUS * 2; y++){
+
+					Vec2f pos = getVec2f(bendingPos.x - BENDING_RADIUS + x, bendingPos.y - BENDING_RADIUS + y);
+
+					if(getMagVec2f(getVec2f(x - BENDING_RADIUS, y - BENDING_RADIUS)) <= BENDING_RADIUS
+					&& !checkOub(pos)
+					&& getStaticParticle(pos) == MATERIAL_BACKGROUND){
+						notOnlyRocks = true;
+					}
+			
+				}
+			}
+
+			for(int x = 0; x < BENDING_RADIUS * 2; x++){
+				for(int y = 0; y < BENDING_RADIUS * 2; y++){
+
+					Vec2f pos = getVec2f(bendingPos.x - BENDING_RADIUS + x, bendingPos.y - BENDING_RADIUS + y);
+
+					if(getMagVec2f(getVec2f(x - BENDING_RADIUS, y - BENDING_RADIUS)) <= BENDING_RADIUS
+					&& !checkOub(pos)
+					&& getStaticParticle(pos) == MATERIAL_ROCK
+					&& notOnlyRocks){
+
+						setStaticParticle(pos, MATERIAL_BACKGROUND, 0, -1);
+
+						addParticle(pos);
+
+					}
+			
+				}
+			}
+		}
+	}
+
+	//handle entity physics
+	{
+		PROFILER_ZONE("entityPhysics");
+
+		std::vector<int> targets;
+
+		updateTargetSpatialHash();
+
+		for(int i = 0; i < entities.size(); i++){
+
+			Entity *entity_p = &entities[i];
+
+			entity_p->physics.acceleration = getVec2f(0.0, 0.0);
+
+			//control players
+			if(entity_p->type == ENTITY_TYPE_PLAYER){
+
+				if(Engine_keys[ENGINE_KEY_A].down){
+					entity_p->physics.acceleration.x += -PLAYER_WALK_SPEED;
+				}
+				if(Engine_keys[ENGINE_KEY_D].down){
+					entity_p->physics.acceleration.x += PLAYER_WALK_SPEED;
+				}
+				if(Engine_keys[ENGINE_KEY_W].down
+				&& entity_p->physics.onGround){
+					entity_p->physics.acceleration.y += -PLAYER_JUMP_SPEED;
+				}
+
+				entity_p->physics.resistance.y = PLAYER_JUMP_RESISTANCE;
+
+				if(!Engine_keys[ENGINE_KEY_W].down
+				&& entity_p->physics.velocity.y < 0){
+					entity_p->physics.resistance.y = PLAYER_STOP_JUMP_RESISTANCE;
+				}
+
+			}
+
+			//control enemies
+			if(entity_p->type == ENTITY_TYPE_ENEMY){
+
+				entity_p->enemyAI.clock++;
+
+				Vec2f enemyPos = getAddVec2f(entity_p->body.pos, getDivVec2fFloat(entity_p->body.size, 2.0));
+
+				//targets the closest player whose center is within the detection radius
+				Vec2f playerPos;
+				float playerDistance = 0.0;
+
+				bool aggro = false;
+
+				targets.clear();
+				getTargetsInRadius(enemyPos, ENEMY_DETECTION_RADIUS, &targets);
+
+				for(int j = 0; j < targets.size(); j++){
+
+					Entity *target_p = &entities[targets[j]];
+
+					Vec2f targetPos = getAddVec2f(target_p->body.pos, getDivVec2fFloat(target_p->body.size, 2.0));
+					float targetDistance = getMagVec2f(getSubVec2f(targetPos, enemyPos));
+
+					if(targetDistance <= ENEMY_DETECTION_RADIUS
+					&& (!aggro || targetDistance < playerDistance)){
+						playerPos = targetPos;
+						playerDistance = targetDistance;
+						aggro = true;
+					}
+
+				}
+
+				entity_p->enemyAI.shouldJump = aggro;
+
+				if(aggro){
+
+					float direction = 1.0;
+					if(entity_p->body.pos.x + entity_p->body.size.x > playerPos.x){
+						direction = -1.0;
+					}
+
+					entity_p->physics.acceleration.x += ENEMY_WALK_SPEED * direction;
+
+					if(entity_p->enemyAI.shouldJump
+					&& entity_p->physics.onGround){
+						entity_p->physics.acceleration.y -= ENEMY_JUMP_SPEED;
+					}
+
+					bool shouldShoot = false;
+					if(entity_p->enemyAI.clock % 30 == 0){
+						shouldShoot = true;
+					}
+
+					if(shouldShoot){
+
+						Vec2f velocity = getSubVec2f(playerPos, enemyPos);
+						Vec2f_normalize(&velocity);
+						Vec2f_mulByFloat(&velocity, BULLET_SPEED);
+					
+						addBullet(enemyPos, velocity);
+
+						//adding the bullet can move the entities
+						entity_p = &entities[i];
+
+					}
+			
+				}
+
+			}
+
+			if(entity_p->type == ENTITY_TYPE_PLAYER
+			|| entity_p->type == ENTITY_TYPE_ENEMY){
+				entity_p->physics.acceleration.y += PLAYER_GRAVITY;
+			}
+
+			Vec2f_add(&entity_p->physics.velocity, entity_p->physics.acceleration);
+			Vec2f_mul(&entity_p->physics.velocity, entity_p->physics.resistance);
+
+			entity_p->physics.onGround = false;
+
+			entity_p->lastBody = entity_p->body;
+	
+		}
+	}
+
+	//handle particle physics
+	{
+		PROFILER_ZONE("integrateParticles");
+
+		ParticleForces forces;
+		forces.gravity = PARTICLE_GRAVITY;
+		forces.resistance = PARTICLE_RESISTANCE;
+		forces.bending = isBending;
+		forces.bendingPos = bendingPos;
+		forces.bendingForce = BENDING_FORCE;
+
+		Particles_integrate(&particles, forces);
+	}
+
+	//move and collide things
+	for(int c = 0; c < 2; c++){
+
+		//move entities
+		for(int i = 0; i < entities.size(); i++){
 
 			Entity *entity_p = &entities[i];
 
-			if(!(entity_p->type == ENTITY_TYPE_PLAYER
-			|| entity_p->type == ENTITY_TYPE_ENEMY)){
-				continue;
-			}
+			entity_p->body.pos[c] += entity_p->physics.velocity[c];
+		
+		}
+
+		removedParticles.assign(particles.length, 0);
+
+		//move particles
+		{
+			PROFILER_ZONE("moveParticles");
+
+			JobSystem_parallelFor(particles.length, PARTICLES_PER_JOB, moveParticlesJob, &c);
+		}
+
+		//handle static particle collisions
+		{
+			PROFILER_ZONE("staticParticleCollisions");
+
+			updateParticleLines(c);
+
+			JobSystem_parallelFor(particleLines.starts.size() - 1, PARTICLE_LINES_PER_JOB, handleStaticParticleCollisionsJob, &c);
+
+			rebuildStaleCrossingOccupancies(c);
+		}
+
+		//indices into particles change here, so this has to happen before collisionIndexGrid is rebuilt
+		{
+			PROFILER_ZONE("compactParticles");
+
+			Particles_removeMarked(&particles, &removedParticles);
+
+			updateParticleLines(c);
+		}
+
+		//put particles into collision index grid and handle moving particle, static rock and oub collisions
+		{
+			PROFILER_ZONE("movingParticleCollisions");
+
+			clearCollisionIndexGrid();
+
+			JobSystem_parallelFor(particleLines.starts.size() - 1, PARTICLE_LINES_PER_JOB, handleMovingParticleCollisionsJob, &c);
+
+			for(int i = 0; i < particleLines.oubParticleIndices.size(); i++){
+				handleParticleOub(particleLines.oubParticleIndices[i], c, 0);
+			}
+		}
+
+		//handle entity particle collisions for players and enemies
+		{
+			PROFILER_ZONE("entityParticleCollisions");
+
+			for(int i = 0; i < entities.size(); i++){
+
+				Entity *entity_p = &entities[i];
+
+				if(!(entity_p->type == ENTITY_TYPE_PLAYER
+				|| entity_p->type == ENTITY_TYPE_ENEMY)){
+					continue;
+				}
+
+				//the occupied cells of the body are found a row of cells at a time, in the same order as walking every cell, x then y
+				//a hit moves the body, so the walk goes on after the hit with the new position
+				int x = 0;
+				int y = 0;
+
+				//handle player moving particle collisions
+				while(findOccupiedBodyCell(entity_p->body, c, GRID_OCCUPANCY_PARTICLE, &x, &y)){
+
+					Vec2f pos = entity_p->body.pos;
+
+					pos.x += x;
+					pos.y += y;
+
+					float entityCenter = entity_p->lastBody.pos[c] + entity_p->lastBody.size[c] / 2.0;
+					float particlePos = particles.lastPos[c][getCollisionIndex(pos)];
+
+					if(particlePos < entityCenter){
+						entity_p->body.pos[c] = (int)pos[c] + 1;
+					}else{
+
+						entity_p->body.pos[c] = (int)(pos[c] - entity_p->body.size[c]);
+
+						if(c == 1){
+							entity_p->physics.onGround = true;
+						}
+
+					}
+				
+					entity_p->physics.velocity[c] = 0.0;
+
+					y++;
+
+				}
+
+				x = 0;
+				y = 0;
+
+				//handle entities static particle collisions
+				while(findOccupiedBodyCell(entity_p->body, c, GRID_OCCUPANCY_SOLID, &x, &y)){
+
+					Vec2f pos = entity_p->body.pos;
+
+					pos.x += x;
+					pos.y += y;
+
+					float entityCenter = entity_p->lastBody.pos[c] + entity_p->lastBody.size[c] / 2.0;
+					float particlePos = pos[c];
+
+					if(particlePos < entityCenter){
+						entity_p->body.pos[c] = (int)pos[c] + 1;
+					}else{
+
+						entity_p->body.pos[c] = (int)(pos[c] - entity_p->body.size[c]);
+
+						if(c == 1){
+							entity_p->physics.onGround = true;
+						}
+
+					}
+				
+					entity_p->physics.velocity[c] = 0.0;
+
+					y++;
+
+				}
+
+				//handle entity oub
+				if(entity_p->body.pos[c] < 0.0){
+					entity_p->body.pos[c] = 0.0;
+				}
+				if(entity_p->body.pos[c] + entity_p->body.size[c] > GRID_WIDTH){
+					entity_p->body.pos[c] = GRID_WIDTH - entity_p->body.size[c];
+				}
+
+				x = 0;
+				y = 0;
+
+				//handle player moving particle collisions second time
+				//particles are moved out of the body along the axis, so they are never found again by the walk
+				while(findOccupiedBodyCell(entity_p->body, c, GRID_OCCUPANCY_PARTICLE, &x, &y)){
+
+					Vec2f pos = entity_p->body.pos;
+
+					pos.x += x;
+					pos.y += y;
+
+					int particleIndex = getCollisionIndex(pos);
+
+					//the particle has to end up outside the body, the cells from its start to its end along the axis are skipped
+					int bodyStart = (int)floorf(pos[c]) - (c == 0 ? x : y);
+
+					int steps = findNearestFreeCell(pos, c, GRID_WIDTH, (1 << GRID_OCCUPANCY_STATIC) | (1 << GRID_OCCUPANCY_PARTICLE), bodyStart, bodyStart + (int)entity_p->body.size[c], 0);
+
+					if(steps != 0){
+
+						Vec2f checkPos = pos;
+						checkPos[c] += steps;
+
+						Particles_setPos(&particles, particleIndex, checkPos);
+						setCollisionIndex(checkPos, particleIndex, c, 0);
+
+					}else{
+						removedParticles[particleIndex] = 1;
+					}
+
+					resetCollisionIndex(pos, c);
+
+					y++;
+
+				}
+		
+			}
+		}
+
+		//handle entity particle collisions for bullets
+		{
+			PROFILER_ZONE("bulletCollisions");
+
+			std::vector<int> targets;
+
+			updateTargetSpatialHash();
+
+			removedEntities.assign(entities.size(), 0);
+
+			for(int i = 0; i < entities.size(); i++){
+
+				Entity *entity_p = &entities[i];
+
+				if(!(entity_p->type == ENTITY_TYPE_BULLET)){
+					continue;
+				}
+
+				bool hit = false;
+
+				//bullets hit players, but not enemies since they are fired from inside them
+				targets.clear();
+				getTargetsInBox(entity_p->body.pos, entity_p->body.size, &targets);
+
+				if(targets.size() > 0){
+					hit = true;
+				}
+
+				for(int x = 0; x < entity_p->body.size.x; x++){
+					for(int y = 0; y < entity_p->body.size.y; y++){
+
+						Vec2f pos = entity_p->body.pos;
+
+						pos.x += x;
+						pos.y += y;
+
+						if(checkOub(pos)){
+							continue;
+						}
+
+
+						if(getCollisionIndex(pos) != -1
+						|| getStaticParticle(pos) != MATERIAL_BACKGROUND){
+							hit = true;
+						}
+					}
+				}
+
+				if(hit){
+					for(int x = 0; x < BULLET_DESTROY_RADIUS * 2; x++){
+						for(int y = 0; y < BULLET_DESTROY_RADIUS * 2; y++){
+
+							Vec2f pos = getVec2f(entity_p->body.pos.x + entity_p->body.size.y / 2.0 - BULLET_DESTROY_RADIUS + x, entity_p->body.pos.y + entity_p->body.size.y / 2.0 - BULLET_DESTROY_RADIUS + y);
+
+							if(getMagVec2f(getVec2f(x - BULLET_DESTROY_RADIUS, y - BULLET_DESTROY_RADIUS)) <= BULLET_DESTROY_RADIUS
+							&& !checkOub(pos)){
+
+								if(getCollisionIndex(pos) != -1){
+									removedParticles[getCollisionIndex(pos)] = 1;
+								}
+
+								if(getStaticParticle(pos) == MATERIAL_ROCK){
+									setStaticParticle(pos, MATERIAL_BACKGROUND, 0, -1);
+								}
+						
+							}
+
+						}
+					}
+
+					removedEntities[i] = 1;
+
+				}
+
+			}
+
+			removeMarkedEntities();
+		}
+
+		//remove particles
+		{
+			PROFILER_ZONE("removeParticles");
+
+			Particles_removeMarked(&particles, &removedParticles);
+		}
+
+	}
+
+	freeEmptyGridChunks();
+
+	//handle camera
+	{
+		PROFILER_ZONE("camera");
+
+
+		Entity *player_p = &entities[0];
+
+		float playerPointerDiffX = bendingPos.x - player_p->body.pos.x;
+		float playerPointerDiffY = bendingPos.y - player_p->body.pos.y;
+
+		playerPointerDiffX *= 0.4;
+		playerPointerDiffY *= 0.2;
+
+		cameraDest.x = (WIDTH / 2.0 - (player_p->body.pos.x + player_p->body.size.x / 2.0)) - playerPointerDiffX;
+		cameraDest.y = (HEIGHT / 2.0 - (player_p->body.pos.y + player_p->body.size.y / 2.0)) - playerPointerDiffY;
 
-			//handle player moving particle collisions
-			for(int x = 0; x < entity_p->body.size.x; x++){
-				for(int y = 0; y < entity_p->body.size.y; y++){
+		if(cameraDest.x > 0){
+			cameraDest.x = 0;
+		}
+		if(cameraDest.y > 0){
+			cameraDest.y = 0;
+		}
+		if(cameraDest.x < -(GRID_WIDTH - WIDTH)){
+			cameraDest.x = -(GRID_WIDTH - WIDTH);
+		}
+		if(cameraDest.y < -(GRID_HEIGHT - HEIGHT)){
+			cameraDest.y = -(GRID_HEIGHT - HEIGHT);
+		}
 
-					Vec2f pos = entity_p->body.pos;
+		lastCameraPos = cameraPos;
 
-					pos.x += x;
-					pos.y += y;
+		Vec2f diff = getSubVec2f(cameraDest, cameraPos);
+		Vec2f_divByFloat(&diff, CAMERA_SPEED);
 
-					if(checkOub(pos)){
-						continue;
-					}
+		Vec2f_add(&cameraPos, diff);
 
-					int index = getGridIndex(pos);
+		if(firstFrame){
+			cameraPos = cameraDest;
+			lastCameraPos = cameraPos;
+		}
+	
+	}
 
-					if(collisionIndexGrid[index] != -1){
+	firstFrame = false;
 
-						Particle *particle_p = &particles[collisionIndexGrid[index]];
+	for(int i = 0; i < freeCellSearchStats.size(); i++){
 
-						float entityCenter = entity_p->lastBody.pos[c] + entity_p->lastBody.size[c] / 2.0;
-						float particlePos = particle_p->lastPos[c];
+		Profiler_count("freeCellSearchProbes", freeCellSearchStats[i].probes);
+		Profiler_count("freeCellSearchLineReads", freeCellSearchStats[i].lineReads);
+		Profiler_count("freeCellSearchDirectChecks", freeCellSearchStats[i].directChecks);
 
-						if(particlePos < entityCenter){
-							entity_p->body.pos[c] = (int)pos[c] + 1;
-						}else{
+		freeCellSearchStats[i].probes = 0;
+		freeCellSearchStats[i].lineReads = 0;
+		freeCellSearchStats[i].directChecks = 0;
 
-							entity_p->body.pos[c] = (int)(pos[c] - entity_p->body.size[c]);
+	}
 
-							if(c == 1){
-								entity_p->physics.onGround = true;
-							}
+	lastUpdateTime = (Engine_getTimeNanoseconds() - updateStartTime) / 1000000.0;
 
-						}
-						
-						entity_p->physics.velocity[c] = 0.0;
+}
 
-					}
-				
-				}
-			}
+void Engine_draw(float alpha){
 
-			//handle entities static particle collisions
-			for(int x = 0; x < entity_p->body.size.x; x++){
-				for(int y = 0; y < entity_p->body.size.y; y++){
+	Vec2f drawCameraPos = getInterpolatedVec2f(lastCameraPos, cameraPos, alpha);
 
-					Vec2f pos = entity_p->body.pos;
-					pos.x += x;
-					pos.y += y;
+	renderer.offset = drawCameraPos;
 
-					if(checkOub(pos)){
-						continue;
-					}
+	Renderer2D_updateDrawSize(&renderer, Engine_clientWidth, Engine_clientHeight);
 
-					int index = getGridIndex(pos);
+	Renderer2D_clear(&renderer);
 
-					if(staticParticlesGrid[index] == ROCK_COLOR
-					|| staticParticlesGrid[index] == STATIC_ROCK_COLOR){
+	Renderer2D_beginBatch(&renderer);
 
-						Particle *particle_p = &particles[collisionIndexGrid[index]];
+	//draw grid
+	//only chunks in view are drawn, and those that changed or had particles drawn into them are restored from the static grid first
+	int startChunkX = fmax(0.0, floor(-drawCameraPos.x / GRID_CHUNK_SIZE));
+	int startChunkY = fmax(0.0, floor(-drawCameraPos.y / GRID_CHUNK_SIZE));
+	int endChunkX = fmin(GRID_CHUNKS_WIDTH - 1, floor((-drawCameraPos.x + WIDTH) / GRID_CHUNK_SIZE));
+	int endChunkY = fmin(GRID_CHUNKS_HEIGHT - 1, floor((-drawCameraPos.y + HEIGHT) / GRID_CHUNK_SIZE));
 
-						float entityCenter = entity_p->lastBody.pos[c] + entity_p->lastBody.size[c] / 2.0;
-						float particlePos = pos[c];
+	{
+		PROFILER_ZONE("restoreGridChunks");
 
-						if(particlePos < entityCenter){
-							entity_p->body.pos[c] = (int)pos[c] + 1;
-						}else{
+		for(int chunkY = startChunkY; chunkY <= endChunkY; chunkY++){
+			for(int chunkX = startChunkX; chunkX <= endChunkX; chunkX++){
 
-							entity_p->body.pos[c] = (int)(pos[c] - entity_p->body.size[c]);
+				GridChunk *chunk_p = gridChunks[GRID_CHUNKS_WIDTH * chunkY + chunkX];
 
-							if(c == 1){
-								entity_p->physics.onGround = true;
-							}
+				if(chunk_p == NULL){
+					continue;
+				}
 
-						}
-						
-						entity_p->physics.velocity[c] = 0.0;
+				if(!chunk_p->hasTexture){
+					chunk_p->drawing = (Pixel *)malloc(sizeof(Pixel) * GRID_CHUNK_AREA);
+					Texture_initEmpty(&chunk_p->texture, "gridChunk", GRID_CHUNK_SIZE, GRID_CHUNK_SIZE);
+					chunk_p->hasTexture = true;
+					chunk_p->dirty = 1;
+				}
 
+				if(chunk_p->dirty
+				|| chunk_p->hasDrawnParticles){
+					for(int i = 0; i < GRID_CHUNK_AREA; i++){
+						chunk_p->drawing[i] = MATERIAL_COLORS[chunk_p->staticParticles[i]];
 					}
-				
+
+					chunk_p->dirty = 0;
+					chunk_p->hasDrawnParticles = false;
+					chunk_p->needsUpload = true;
 				}
-			}
 
-			//handle entity oub
-			if(entity_p->body.pos[c] < 0.0){
-				entity_p->body.pos[c] = 0.0;
 			}
-			if(entity_p->body.pos[c] + entity_p->body.size[c] > GRID_WIDTH){
-				entity_p->body.pos[c] = GRID_WIDTH - entity_p->body.size[c];
+		}
+	}
+
+	//place rock particles in grid
+	{
+		PROFILER_ZONE("drawParticles");
+
+		for(int i = 0; i < particles.length; i++){
+
+			Vec2f particlePos = getInterpolatedVec2f(Particles_getLastPos(&particles, i), Particles_getPos(&particles, i), alpha);
+
+			if(checkOub(particlePos)
+			|| (int)particlePos.x < startChunkX * GRID_CHUNK_SIZE
+			|| (int)particlePos.y < startChunkY * GRID_CHUNK_SIZE
+			|| (int)particlePos.x >= (endChunkX + 1) * GRID_CHUNK_SIZE
+			|| (int)particlePos.y >= (endChunkY + 1) * GRID_CHUNK_SIZE){
+				continue;
 			}
 
-			//handle player moving particle collisions second time
-			for(int x = 0; x < entity_p->body.size.x; x++){
-				for(int y = 0; y < entity_p->body.size.y; y++){
+			GridChunk *chunk_p = getGridChunk(particlePos);
 
-					Vec2f pos = entity_p->body.pos;
+			//between ticks a particle can be drawn where there is no chunk, so it has no chunk texture to be drawn into
+			if(chunk_p == NULL){
+				chunklessDrawnParticles.push_back(particlePos);
+				continue;
+			}
 
-					pos.x += x;
-					pos.y += y;
+			chunk_p->drawing[getGridChunkCellIndex(particlePos)] = MATERIAL_COLORS[MATERIAL_ROCK];
+			chunk_p->hasDrawnParticles = true;
+			chunk_p->needsUpload = true;
 
-					if(checkOub(pos)){
-						continue;
-					}
+		}
+	}
 
-					int index = getGridIndex(pos);
+	//upload and draw chunks in view
+	{
+		PROFILER_ZONE("uploadGridChunks");
 
-					if(collisionIndexGrid[index] != -1){
+		Renderer2D_setShader(&renderer, renderer.textureShader);
 
-						Particle *particle_p = &particles[collisionIndexGrid[index]];
+		for(int chunkY = startChunkY; chunkY <= endChunkY; chunkY++){
+			for(int chunkX = startChunkX; chunkX <= endChunkX; chunkX++){
 
-						Vec2f checkPos = pos;
-						int steps = 0;
+				GridChunk *chunk_p = gridChunks[GRID_CHUNKS_WIDTH * chunkY + chunkX];
+
+				if(chunk_p == NULL){
+					continue;
+				}
 
-						while(true){
+				if(chunk_p->needsUpload){
+					Texture_updateRegion(&chunk_p->texture, (unsigned char *)chunk_p->drawing, GRID_CHUNK_SIZE, 0, 0, GRID_CHUNK_SIZE, GRID_CHUNK_SIZE);
+					chunk_p->needsUpload = false;
+				}
 
-							steps++;
-							{
-								checkPos = pos;
-								checkPos[c] += steps;
-								int checkIndex = getGridIndex(checkPos);
+				Renderer2D_setTexture(&renderer, chunk_p->texture);
 
-								if(!checkOub(checkPos)
-								&& collisionIndexGrid[checkIndex] == -1
-								&& staticParticlesGrid[checkIndex] == BACKGROUND_COLOR
-								&& (checkPos[c] < entity_p->body.pos[c] || checkPos[c] > entity_p->body.pos[c] + entity_p->body.size[c])){
-									
-									particle_p->pos = checkPos;
-									collisionIndexGrid[checkIndex] = collisionIndexGrid[index];
-									break;
+				Renderer2D_drawRectangle(&renderer, chunkX * GRID_CHUNK_SIZE, chunkY * GRID_CHUNK_SIZE, GRID_CHUNK_SIZE, GRID_CHUNK_SIZE);
 
-								}
-							
-							}
-							{
-								checkPos = pos;
-								checkPos[c] -= steps;
-								int checkIndex = getGridIndex(checkPos);
+			}
+		}
+	}
 
-								if(!checkOub(checkPos)
-								&& collisionIndexGrid[checkIndex] == -1
-								&& staticParticlesGrid[checkIndex] == BACKGROUND_COLOR
-								&& (checkPos[c] < entity_p->body.pos[c] || checkPos[c] > entity_p->body.pos[c] + entity_p->body.size[c])){
+	Renderer2D_setShader(&renderer, renderer.colorShader);
 
-									particle_p->pos = checkPos;
-									collisionIndexGrid[checkIndex] = collisionIndexGrid[index];
-									break;
+	Renderer2D_setRotation(&renderer, 0.0);
 
-								}
-							
-							}
-						
-						}
+	//draw particles outside of chunks
+	{
+		PROFILER_ZONE("drawChunklessParticles");
 
-						collisionIndexGrid[index] = -1;
+		Pixel color = MATERIAL_COLORS[MATERIAL_ROCK];
 
-					}
-				
-				}
+		Renderer2D_setColor(&renderer, getVec4f(color.r / 255.0, color.g / 255.0, color.b / 255.0, color.a / 255.0));
 
-			}
-		
+		for(int i = 0; i < chunklessDrawnParticles.size(); i++){
+			Renderer2D_drawRectangle(&renderer, (int)chunklessDrawnParticles[i].x, (int)chunklessDrawnParticles[i].y, 1, 1);
 		}
 
-		//handle entity particle collisions for bullets
+		chunklessDrawnParticles.clear();
+	}
+
+	//draw entities
+	{
+		PROFILER_ZONE("drawEntities");
+
 		for(int i = 0; i < entities.size(); i++){
 
 			Entity *entity_p = &entities[i];
 
-			if(!(entity_p->type == ENTITY_TYPE_BULLET)){
-				continue;
+			if(entity_p->type == ENTITY_TYPE_PLAYER){
+				Renderer2D_setColor(&renderer, PLAYER_COLOR);
+			}
+			if(entity_p->type == ENTITY_TYPE_ENEMY){
+				Renderer2D_setColor(&renderer, ENEMY_COLOR);
+			}
+			if(entity_p->type == ENTITY_TYPE_BULLET){
+				Renderer2D_setColor(&renderer, BULLET_COLOR);
 			}
 
-			bool hit = false;
+			Vec2f entityPos = getInterpolatedVec2f(entity_p->lastBody.pos, entity_p->body.pos, alpha);
 
-			for(int x = 0; x < entity_p->body.size.x; x++){
-				for(int y = 0; y < entity_p->body.size.y; y++){
+			Renderer2D_drawRectangle(&renderer, (int)entityPos.x, (int)entityPos.y, entity_p->body.size.x, entity_p->body.size.y);
+	
+		}
+	}
 
-					Vec2f pos = entity_p->body.pos;
+	//bending pos
+	//Renderer2D_setColor(&renderer, getVec4f(1.0, 0.0, 0.0, 1.0));
 
-					pos.x += x;
-					pos.y += y;
+	//Renderer2D_drawRectangle(&renderer, bendingPos.x, bendingPos.y, 10, 10);
 
-					if(checkOub(pos)){
-						continue;
-					}
+	//draw hud
+	if(showHud){
 
-					int index = getGridIndex(pos);
+		char hudText[STRING_SIZE];
+		sprintf(hudText, "update %.2f ms\nparticles %i\nentities %i", lastUpdateTime, particles.length, (int)entities.size());
 
-					if(collisionIndexGrid[index] != -1
-					|| staticParticlesGrid[index] != BACKGROUND_COLOR){
-						hit = true;
-					}
-				}
-			}
+		//the hud is drawn in screen space
+		Vec2f offset = renderer.offset;
+		renderer.offset = getVec2f(0.0, 0.0);
 
-			if(hit){
-				for(int x = 0; x < BULLET_DESTROY_RADIUS * 2; x++){
-					for(int y = 0; y < BULLET_DESTROY_RADIUS * 2; y++){
+		Renderer2D_setColor(&renderer, getVec4f(1.0, 1.0, 1.0, 1.0));
 
-						Vec2f pos = getVec2f(entity_p->body.pos.x + entity_p->body.size.y / 2.0 - BULLET_DESTROY_RADIUS + x, entity_p->body.pos.y + entity_p->body.size.y / 2.0 - BULLET_DESTROY_RADIUS + y);
-						int index = getGridIndex(pos);
+		Renderer2D_drawText(&renderer, hudText, 4.0, 4.0, &hudFont);
 
-						if(getMagVec2f(getVec2f(x - BULLET_DESTROY_RADIUS, y - BULLET_DESTROY_RADIUS)) <= BULLET_DESTROY_RADIUS
-						&& !checkOub(pos)){
+		renderer.offset = offset;
 
-							if(collisionIndexGrid[index] != -1){
-								removedParticleIDs.push_back(particles[collisionIndexGrid[index]].ID);
-							}
+	}
 
-							if(staticParticlesGrid[index] == ROCK_COLOR){
-								staticParticlesGrid[index] = BACKGROUND_COLOR;
-							}
-						
-						}
+	Renderer2D_endBatch(&renderer);
 
-					}
-				}
 
-				entities.erase(entities.begin() + i, entities.begin() + i + 1);
-				i--;
-				continue;
-			}
+}
+
+void Engine_finnish(){
 
+	for(int i = 0; i < gridChunks.size(); i++){
+		if(gridChunks[i] != NULL){
+			freeGridChunk(i);
 		}
+	}
 
-		//remove particles
-		for(int i = 0; i < particles.size(); i++){
-			for(int j = 0; j < removedParticleIDs.size(); j++){
-				
-				if(particles[i].ID == removedParticleIDs[j]){
-					particles.erase(particles.begin() + i, particles.begin() + i + 1);
-					i--;
-					break;
-				}
+}
 
-			}
+static void addToStateHash(unsigned long long *hash_p, const void *data, size_t size){
+
+	const unsigned char *bytes = (const unsigned char *)data;
+
+	for(size_t i = 0; i < size; i++){
+		*hash_p ^= bytes[i];
+		*hash_p *= 1099511628211ULL;
+	}
+
+}
+
+//FNV-1a over the static cells, the particles and the entities, which is everything an update reads from the tick before
+unsigned long long Engine_getStateHash(){
+
+	unsigned long long hash = 14695981039346656037ULL;
+
+	//chunks without static particles are left out, since when they are freed does not change the world
+	for(int i = 0; i < gridChunks.size(); i++){
+		if(gridChunks[i] != NULL
+		&& gridChunks[i]->numberOfStaticCells > 0){
+			addToStateHash(&hash, &i, sizeof(int));
+			addToStateHash(&hash, gridChunks[i]->staticParticles, GRID_CHUNK_AREA);
 		}
+	}
 
+	addToStateHash(&hash, &particles.length, sizeof(int));
+
+	for(int i = 0; i < 2; i++){
+		addToStateHash(&hash, particles.pos[i].data(), particles.length * sizeof(float));
+		addToStateHash(&hash, particles.velocity[i].data(), particles.length * sizeof(float));
 	}
 
-	//handle camera
-	{
+	for(int i = 0; i < entities.size(); i++){
+		addToStateHash(&hash, &entities[i].type, sizeof(enum EntityType));
+		addToStateHash(&hash, &entities[i].body, sizeof(Body));
+		addToStateHash(&hash, &entities[i].physics.velocity, sizeof(Vec2f));
+	}
 
-		Entity *player_p = &entities[0];
+	return hash;
 
-		float playerPointerDiffX = bendingPos.x - player_p->body.pos.x;
-		float playerPointerDiffY = bendingPos.y - player_p->body.pos.y;
+}
 
-		playerPointerDiffX *= 0.4;
-		playerPointerDiffY *= 0.2;
+//WORLD SNAPSHOTS
 
-		cameraDest.x = (WIDTH / 2.0 - (player_p->body.pos.x + player_p->body.size.x / 2.0)) - playerPointerDiffX;
-		cameraDest.y = (HEIGHT / 2.0 - (player_p->body.pos.y + player_p->body.size.y / 2.0)) - playerPointerDiffY;
+//saves the static grid, the particles and the entities, which is the state Engine_getStateHash covers
+bool Engine_saveSnapshot(const char *path){
 
-		if(cameraDest.x > 0){
-			cameraDest.x = 0;
+	long long startTime = Engine_getTimeNanoseconds();
+
+	std::vector<unsigned char> encodedChunks;
+	int numberOfChunks = 0;
+
+	//empty chunks are kept as well, so that the loaded grid has the same chunks as the saved one
+	for(int i = 0; i < gridChunks.size(); i++){
+
+		if(gridChunks[i] == NULL){
+			continue;
 		}
-		if(cameraDest.y > 0){
-			cameraDest.y = 0;
+
+		size_t chunkHeaderOffset = encodedChunks.size();
+		encodedChunks.resize(chunkHeaderOffset + sizeof(WorldSnapshotChunkHeader));
+
+		RunLength_encode(&encodedChunks, gridChunks[i]->staticParticles, GRID_CHUNK_AREA);
+
+		WorldSnapshotChunkHeader chunkHeader;
+		chunkHeader.chunkIndex = i;
+		chunkHeader.encodedSize = encodedChunks.size() - chunkHeaderOffset - sizeof(WorldSnapshotChunkHeader);
+
+		memcpy(&encodedChunks[chunkHeaderOffset], &chunkHeader, sizeof(WorldSnapshotChunkHeader));
+
+		numberOfChunks++;
+
+	}
+
+	WorldSnapshotHeader header;
+	memset(&header, 0, sizeof(WorldSnapshotHeader));
+	memcpy(header.magic, WORLD_SNAPSHOT_MAGIC, 4);
+	header.version = WORLD_SNAPSHOT_VERSION;
+	header.gridWidth = GRID_WIDTH;
+	header.gridHeight = GRID_HEIGHT;
+	header.gridChunkSize = GRID_CHUNK_SIZE;
+	header.numberOfChunks = numberOfChunks;
+	header.numberOfParticles = particles.length;
+	header.numberOfEntities = entities.size();
+	header.currentParticleID = currentParticleID;
+	header.cameraPos = cameraPos;
+	header.cameraDest = cameraDest;
+
+	FileWriter fileWriter;
+
+	if(!FileWriter_init(&fileWriter, path)){
+		return false;
+	}
+
+	FileWriter_write(&fileWriter, &header, sizeof(WorldSnapshotHeader));
+	FileWriter_write(&fileWriter, encodedChunks.data(), encodedChunks.size());
+
+	FileWriter_write(&fileWriter, particles.IDs.data(), particles.length * sizeof(size_t));
+
+	for(int c = 0; c < 2; c++){
+		FileWriter_write(&fileWriter, particles.pos[c].data(), particles.length * sizeof(float));
+		FileWriter_write(&fileWriter, particles.velocity[c].data(), particles.length * sizeof(float));
+	}
+
+	FileWriter_write(&fileWriter, entities.data(), entities.size() * sizeof(Entity));
+
+	long int fileSize = ftell(fileWriter.file_p);
+
+	if(!FileWriter_finish(&fileWriter)){
+		return false;
+	}
+
+	printf("Saved snapshot to %s: %li bytes in %f ms\n", path, fileSize, (Engine_getTimeNanoseconds() - startTime) / 1000000.0);
+
+	return true;
+
+}
+
+//replaces the world with the one in the snapshot, the world is left as it was if the snapshot can not be read
+bool Engine_loadSnapshot(const char *path){
+
+	long long startTime = Engine_getTimeNanoseconds();
+
+	FileView fileView;
+
+	if(!FileView_init(&fileView, path)){
+		return false;
+	}
+
+	WorldSnapshotHeader header;
+
+	if(fileView.size < (long int)sizeof(WorldSnapshotHeader)){
+		printf("Snapshot is too small for its header: %s\n", path);
+		FileView_release(&fileView);
+		return false;
+	}
+
+	memcpy(&header, fileView.data, sizeof(WorldSnapshotHeader));
+
+	if(memcmp(header.magic, WORLD_SNAPSHOT_MAGIC, 4) != 0
+	|| header.version != WORLD_SNAPSHOT_VERSION){
+		printf("Not a snapshot of this version: %s\n", path);
+		FileView_release(&fileView);
+		return false;
+	}
+
+	if(header.gridWidth != GRID_WIDTH
+	|| header.gridHeight != GRID_HEIGHT
+	|| header.gridChunkSize != GRID_CHUNK_SIZE){
+		printf("Snapshot is of a %ix%i grid with chunks of %i, not %ix%i with chunks of %i: %s\n", header.gridWidth, header.gridHeight, header.gridChunkSize, GRID_WIDTH, GRID_HEIGHT, GRID_CHUNK_SIZE, path);
+		FileView_release(&fileView);
+		return false;
+	}
+
+	//the chunks are decoded into new chunks first so that a broken snapshot does not leave half a world behind
+	std::vector<GridChunk *> loadedGridChunks(gridChunks.size(), NULL);
+
+	const unsigned char *data = (const unsigned char *)fileView.data;
+	long int offset = sizeof(WorldSnapshotHeader);
+	bool failed = false;
+
+	for(int i = 0; i < header.numberOfChunks && !failed; i++){
+
+		WorldSnapshotChunkHeader chunkHeader;
+
+		if(offset + (long int)sizeof(WorldSnapshotChunkHeader) > fileView.size){
+			failed = true;
+			break;
 		}
-		if(cameraDest.x < -(GRID_WIDTH - WIDTH)){
-			cameraDest.x = -(GRID_WIDTH - WIDTH);
+
+		memcpy(&chunkHeader, data + offset, sizeof(WorldSnapshotChunkHeader));
+		offset += sizeof(WorldSnapshotChunkHeader);
+
+		if(chunkHeader.chunkIndex < 0
+		|| chunkHeader.chunkIndex >= loadedGridChunks.size()
+		|| loadedGridChunks[chunkHeader.chunkIndex] != NULL
+		|| chunkHeader.encodedSize < 0
+		|| offset + chunkHeader.encodedSize > fileView.size){
+			failed = true;
+			break;
 		}
-		if(cameraDest.y < -(GRID_HEIGHT - HEIGHT)){
-			cameraDest.y = -(GRID_HEIGHT - HEIGHT);
+
+		GridChunk *chunk_p = (GridChunk *)malloc(sizeof(GridChunk));
+
+		loadedGridChunks[chunkHeader.chunkIndex] = chunk_p;
+
+		if(RunLength_decode(chunk_p->staticParticles, GRID_CHUNK_AREA, data + offset, chunkHeader.encodedSize) != chunkHeader.encodedSize){
+			failed = true;
+			break;
 		}
 
-		Vec2f diff = getSubVec2f(cameraDest, cameraPos);
-		Vec2f_divByFloat(&diff, CAMERA_SPEED);
+		offset += chunkHeader.encodedSize;
 
-		Vec2f_add(&cameraPos, diff);
+		chunk_p->numberOfStaticCells = 0;
+
+		memset(chunk_p->occupancyRows, 0, sizeof(chunk_p->occupancyRows));
+		memset(chunk_p->occupancyColumns, 0, sizeof(chunk_p->occupancyColumns));
+
+		for(int j = 0; j < GRID_CHUNK_AREA; j++){
+
+			unsigned char material = chunk_p->staticParticles[j];
+
+			chunk_p->numberOfStaticCells += material != MATERIAL_BACKGROUND;
+			chunk_p->collisionIndices[j] = -1;
+
+			setGridChunkStaticOccupancies(chunk_p, j, (enum Material)material, 0, true);
 
-		if(firstFrame){
-			cameraPos = cameraDest;
 		}
 
-		renderer.offset = cameraPos;
-	
+		chunk_p->numberOfEmptyTicks = 0;
+		chunk_p->hasCollisionIndices = 0;
+		chunk_p->hasParticleOccupancy = 0;
+		chunk_p->hasStaleCrossingOccupancies = 0;
+		chunk_p->dirty = 1;
+		chunk_p->hasDrawnParticles = false;
+		chunk_p->needsUpload = false;
+		chunk_p->hasTexture = false;
+		chunk_p->drawing = NULL;
+
 	}
 
-	firstFrame = false;
+	long int particlesSize = (long int)header.numberOfParticles * (sizeof(size_t) + 4 * sizeof(float));
+	long int entitiesSize = (long int)header.numberOfEntities * sizeof(Entity);
 
-}
+	if(header.numberOfParticles < 0
+	|| header.numberOfEntities < 0
+	|| offset + particlesSize + entitiesSize != fileView.size){
+		failed = true;
+	}
 
-void Engine_draw(){
+	//the camera follows entities[0], so the world needs a player there
+	if(!failed){
 
-	Renderer2D_updateDrawSize(&renderer, Engine_clientWidth, Engine_clientHeight);
+		Entity firstEntity;
 
-	Renderer2D_clear(&renderer);
+		if(header.numberOfEntities > 0){
+			memcpy(&firstEntity, data + offset + particlesSize, sizeof(Entity));
+		}
 
-	//draw grid
-	memcpy(drawingGrid, staticParticlesGrid, sizeof(Pixel) * GRID_WIDTH * GRID_HEIGHT);
+		if(header.numberOfEntities == 0
+		|| firstEntity.type != ENTITY_TYPE_PLAYER){
+			printf("Snapshot has no player as its first entity: %s\n", path);
+			failed = true;
+		}
 
-	//place rock particles in grid
-	for(int i = 0; i < particles.size(); i++){
+	}
 
-		Particle *particle_p = &particles[i];
+	if(failed){
 
-		if(checkOub(particle_p->pos)){
-			continue;
+		printf("Snapshot is broken: %s\n", path);
+
+		for(int i = 0; i < loadedGridChunks.size(); i++){
+			free(loadedGridChunks[i]);
 		}
-		
-		int index = getGridIndex(particle_p->pos);
 
-		drawingGrid[index] = ROCK_COLOR;
+		FileView_release(&fileView);
+
+		return false;
 
 	}
 
-	Renderer2D_setShader(&renderer, renderer.textureShader);
+	//nothing can fail from here, so the old world is replaced
+	clearCollisionIndexGrid();
 
-	Texture_init(&gridTexture, "grid", (unsigned char *)drawingGrid, GRID_WIDTH, GRID_HEIGHT);
+	for(int i = 0; i < gridChunks.size(); i++){
+		if(gridChunks[i] != NULL){
+			freeGridChunk(i);
+		}
+	}
 
-	Renderer2D_setTexture(&renderer, gridTexture);
+	gridChunks = loadedGridChunks;
 
-	Renderer2D_drawRectangle(&renderer, 0, 0, GRID_WIDTH, GRID_HEIGHT);
+	int numberOfParticles = header.numberOfParticles;
 
-	Texture_free(&gridTexture);
+	particles.length = numberOfParticles;
 
-	Renderer2D_setShader(&renderer, renderer.colorShader);
+	particles.IDs.resize(numberOfParticles);
+	memcpy(particles.IDs.data(), data + offset, numberOfParticles * sizeof(size_t));
+	offset += numberOfParticles * sizeof(size_t);
 
-	Renderer2D_setRotation(&renderer, 0.0);
+	for(int c = 0; c < 2; c++){
 
-	//draw entities
-	for(int i = 0; i < entities.size(); i++){
+		particles.pos[c].resize(numberOfParticles);
+		memcpy(particles.pos[c].data(), data + offset, numberOfParticles * sizeof(float));
+		offset += numberOfParticles * sizeof(float);
 
-		Entity *entity_p = &entities[i];
+		particles.velocity[c].resize(numberOfParticles);
+		memcpy(particles.velocity[c].data(), data + offset, numberOfParticles * sizeof(float));
+		offset += numberOfParticles * sizeof(float);
 
-		if(entity_p->type == ENTITY_TYPE_PLAYER){
-			Renderer2D_setColor(&renderer, PLAYER_COLOR);
-		}
-		if(entity_p->type == ENTITY_TYPE_ENEMY){
-			Renderer2D_setColor(&renderer, ENEMY_COLOR);
-		}
-		if(entity_p->type == ENTITY_TYPE_BULLET){
-			Renderer2D_setColor(&renderer, BULLET_COLOR);
-		}
+		particles.lastPos[c] = particles.pos[c];
 
-		Renderer2D_drawRectangle(&renderer, (int)entity_p->body.pos.x, (int)entity_p->body.pos.y, entity_p->body.size.x, entity_p->body.size.y);
-	
 	}
 
-	//bending pos
-	//Renderer2D_setColor(&renderer, getVec4f(1.0, 0.0, 0.0, 1.0));
+	entities.resize(header.numberOfEntities);
+	memcpy(entities.data(), data + offset, header.numberOfEntities * sizeof(Entity));
 
-	//Renderer2D_drawRectangle(&renderer, bendingPos.x, bendingPos.y, 10, 10);
+	currentParticleID = header.currentParticleID;
+	cameraPos = header.cameraPos;
+	lastCameraPos = cameraPos;
+	cameraDest = header.cameraDest;
 
+	FileView_release(&fileView);
 
-}
+	printf("Loaded snapshot from %s in %f ms\n", path, (Engine_getTimeNanoseconds() - startTime) / 1000000.0);
 
-void Engine_finnish(){
+	return true;
 
 }
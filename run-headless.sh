@@ -0,0 +1 @@
+g++ lib/engine/*.cpp lib/glad/gl.c main.cpp -O2 -g -DENGINE_HEADLESS -I ./include/ -ldl -lm -lpthread -o main-headless && ./main-headless "$@"
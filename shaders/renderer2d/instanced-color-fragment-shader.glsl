@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec4 color;
+
+void main(){
+
+	gl_FragColor = color;
+
+	gl_FragDepth = 0.0;
+
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+precision mediump float;
+
+in vec2 textureCoord;
+in vec4 color;
+
+uniform sampler2D tex;
+
+void main(){
+
+	gl_FragColor = vec4(color.rgb, color.a * texture2D(tex, textureCoord).a);
+
+	gl_FragDepth = 0.0;
+
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+precision mediump float;
+
+in vec2 textureCoord;
+in vec4 color;
+
+uniform sampler2D tex;
+
+void main(){
+
+	gl_FragColor = texture2D(tex, textureCoord);
+
+	gl_FragDepth = 0.0;
+
+}
@@ -0,0 +1,41 @@
+#version 330 core
+layout (location = 0) in vec2 vertexPosition_attribute;
+layout (location = 1) in vec2 textureVertex_attribute;
+
+//per instance, rectangle is posX, posY, width and height like the uniforms of color-vertex-shader.glsl
+layout (location = 2) in vec4 rectangle_attribute;
+layout (location = 3) in vec4 color_attribute;
+layout (location = 4) in vec4 textureRegion_attribute;
+layout (location = 5) in float rotation_attribute;
+
+out vec2 textureCoord;
+out vec4 color;
+
+uniform float aspectRatio = 1.0;
+
+vec2 vertexPosition;
+
+void main(){
+
+	textureCoord = textureRegion_attribute.xy + textureVertex_attribute * textureRegion_attribute.zw;
+
+	color = color_attribute;
+
+	vertexPosition = vertexPosition_attribute;
+
+	vertexPosition.x *= rectangle_attribute.z;
+	vertexPosition.y *= rectangle_attribute.w;
+
+	vertexPosition *= mat2(
+		cos(rotation_attribute), -sin(rotation_attribute),
+		sin(rotation_attribute), cos(rotation_attribute)
+	);
+
+	gl_Position = vec4(
+		vertexPosition.x / aspectRatio - 1.0 + rectangle_attribute.x / aspectRatio,
+		vertexPosition.y + 1.0 - rectangle_attribute.y,
+		0.0,
+		1.0
+	);
+
+}
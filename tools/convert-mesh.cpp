@@ -0,0 +1,91 @@
+//converts a .mesh triangle list to an .imesh file with welded vertices and an index buffer, ordered for the post transform cache
+//build and run from the repository root with tools/convert-mesh.sh
+
+#include "engine/mesh.h"
+#include "engine/files.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+//the cache stats are reported for a small FIFO cache like on older and weaker GPUs
+int REPORT_CACHE_SIZE = 16;
+
+int main(int argc, char **argv){
+
+	enum MeshVertexFormat vertexFormat = MESH_VERTEX_FORMAT_FLOAT;
+
+	if(argc == 4
+	&& strcmp(argv[1], "-c") == 0){
+		vertexFormat = MESH_VERTEX_FORMAT_COMPACT;
+		argc--;
+		argv++;
+	}
+
+	if(argc != 3){
+		printf("usage: convert-mesh [-c] input.mesh output.imesh\n");
+		printf("  -c  write compact 16 byte vertices instead of 32 byte float vertices, if the texture coordinates are within 0 to 1\n");
+		return 1;
+	}
+
+	const char *inputPath = argv[1];
+	const char *outputPath = argv[2];
+
+	FileView fileView;
+
+	if(!FileView_init(&fileView, inputPath)){
+		return 1;
+	}
+
+	if(fileView.size % MESH_TRIANGLE_SIZE != 0){
+		printf("Mesh file does not contain whole triangles: %s\n", inputPath);
+		FileView_release(&fileView);
+		return 1;
+	}
+
+	int numberOfTriangles = fileView.size / MESH_TRIANGLE_SIZE;
+
+	IndexedMesh indexedMesh;
+	IndexedMesh_initFromMeshData(&indexedMesh, (const unsigned char *)fileView.data, numberOfTriangles);
+
+	FileView_release(&fileView);
+
+	MeshCacheStats weldedStats = IndexedMesh_getCacheStats(&indexedMesh, REPORT_CACHE_SIZE);
+
+	IndexedMesh_optimizeVertexCache(&indexedMesh);
+	IndexedMesh_optimizeVertexFetch(&indexedMesh);
+
+	MeshCacheStats optimizedStats = IndexedMesh_getCacheStats(&indexedMesh, REPORT_CACHE_SIZE);
+
+	//tiled or negative texture coordinates would be clamped by the compact vertices
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT
+	&& !IndexedMesh_canUseCompactVertices(&indexedMesh)){
+		printf("texture coordinates are outside of 0 to 1, writing float vertices instead of compact ones\n");
+		vertexFormat = MESH_VERTEX_FORMAT_FLOAT;
+	}
+
+	if(!IndexedMesh_writeToFile(&indexedMesh, outputPath, vertexFormat)){
+		return 1;
+	}
+
+	int numberOfVertices = IndexedMesh_getNumberOfVertices(&indexedMesh);
+	int vertexSize = vertexFormat == MESH_VERTEX_FORMAT_COMPACT ? sizeof(CompactMeshVertex) : MESH_VERTEX_SIZE;
+	long int indexedSize = sizeof(IndexedMeshHeader) + numberOfVertices * vertexSize + indexedMesh.indices.size() * IndexedMesh_getIndexSize(&indexedMesh);
+
+	printf("triangles: %i\n", numberOfTriangles);
+	printf("vertices:  %i -> %i\n", numberOfTriangles * 3, numberOfVertices);
+	printf("bytes:     %li -> %li (%i bit indices)\n", (long int)numberOfTriangles * MESH_TRIANGLE_SIZE, indexedSize, IndexedMesh_getIndexSize(&indexedMesh) * 8);
+	printf("ACMR:      %.3f -> %.3f (%i entry FIFO)\n", weldedStats.ACMR, optimizedStats.ACMR, REPORT_CACHE_SIZE);
+	printf("ATVR:      %.3f -> %.3f\n", weldedStats.ATVR, optimizedStats.ATVR);
+
+	if(vertexFormat == MESH_VERTEX_FORMAT_COMPACT){
+
+		MeshQuantizationError error = IndexedMesh_getQuantizationError(&indexedMesh);
+
+		printf("max error: position %g of the bounds, texture coordinate %g, normal %.3f degrees\n", error.position, error.textureCoord, error.normalDegrees);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,6 @@
+#converts .mesh triangle lists to indexed .imesh files
+#run from the repository root: sh tools/convert-mesh.sh [-c] input.mesh output.imesh
+
+g++ tools/convert-mesh.cpp lib/engine/mesh.cpp lib/engine/files.cpp lib/engine/strings.cpp -O2 -I ./include/ -lm -o convert-mesh || exit 1
+
+./convert-mesh "$@"